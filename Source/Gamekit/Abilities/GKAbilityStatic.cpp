@@ -7,5 +7,6 @@ FGKAbilityStatic::FGKAbilityStatic()
 	: MaxLevel(1)
 	, Price(0)
 	, MaxStack(1)
+	, ProjectilePoolSize(0)
 	, AbilityTargetActorClass(AGKAbilityTarget_PlayerControllerTrace::StaticClass())
 {}
\ No newline at end of file
@@ -183,11 +183,15 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Projectile);
 	EGK_ProjectileBehavior ProjectileBehavior;
 
-	//! Max length before the actor destroy itself
+	//! Max length before the actor returns to the pool
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Projectile);
 	float ProjectileRange;
 
-	//!
+	//! Number of projectiles spawned ahead of time when the ability is granted
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Projectile);
+	int32 ProjectilePoolSize;
+
+	//! Actor spawned at the target location, an AGKAOEActor applies the ability effects every period
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = AreaOfEffect);
 	TSubclassOf<AActor> AOEActorClass;
 
@@ -6,8 +6,10 @@
 #include "Abilities/GKGameplayAbility.h"
 #include "Abilities/GKAbilityStatic.h"
 #include "Abilities/Targeting/GKAbilityTarget_PlayerControllerTrace.h"
+#include "Projectiles/GKProjectilePool.h"
 
 #include "AbilitySystemGlobals.h"
+#include "TimerManager.h"
 
 
 UGKAbilitySystemComponent::UGKAbilitySystemComponent() {
@@ -23,6 +25,8 @@ void  UGKAbilitySystemComponent::OnGiveAbility(FGameplayAbilitySpec& AbilitySpec
 	// Generate the ActorInfo an set it on the instance
 	Super::OnGiveAbility(AbilitySpec);
 
+	PrewarmProjectiles(AbilitySpec);
+
 	if (GetOwner() == nullptr) {
 		UE_LOG(LogGamekit, Warning, TEXT("Ability does not have a owner!?"));
 		return;
@@ -44,6 +48,28 @@ UGKAbilitySystemComponent* UGKAbilitySystemComponent::GetAbilitySystemComponentF
 	return Cast<UGKAbilitySystemComponent>(UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Actor, LookForComponent));
 }
 
+void UGKAbilitySystemComponent::PrewarmProjectiles(FGameplayAbilitySpec& AbilitySpec) {
+	// Only the server spawns projectiles
+	UWorld* World = GetWorld();
+	if (World == nullptr || !IsOwnerActorAuthoritative()) {
+		return;
+	}
+
+	auto Ability = Cast<UGKGameplayAbility>(AbilitySpec.Ability);
+	if (Ability == nullptr) {
+		return;
+	}
+
+	FGKAbilityStatic* AbilityData = Ability->GetAbilityStatic();
+	if (AbilityData == nullptr || !AbilityData->ProjectileActorClass || AbilityData->ProjectilePoolSize <= 0) {
+		return;
+	}
+
+	if (auto Pool = World->GetSubsystem<UGKProjectilePoolSubsystem>()) {
+		Pool->Prewarm(AbilityData->ProjectileActorClass, AbilityData->ProjectilePoolSize);
+	}
+}
+
 bool UGKAbilitySystemComponent::IsInitialized() const { return Initialized; }
 
 void UGKAbilitySystemComponent::CancelAllPendingAbilities() {
@@ -60,6 +86,7 @@ void UGKAbilitySystemComponent::CancelAllPendingAbilities() {
 	// Cancel backswing, -1 tries to make the animation blendout seaminglessly
 	// 0.f make a hard reset
 	CurrentMontageStop(0.f);
+	ClearActivationQueue();
 }
 
 void UGKAbilitySystemComponent::LevelUpAbility(FGameplayAbilitySpecHandle Handle) {
@@ -107,6 +134,108 @@ void UGKAbilitySystemComponent::ClientLevelUpAbility_Result_Implementation(FGame
 	}
 }
 
+bool UGKAbilitySystemComponent::TryActivateAbilityQueued(FGameplayAbilitySpecHandle Handle) {
+	FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandle(Handle);
+	if (Spec == nullptr || Spec->Ability == nullptr) {
+		return false;
+	}
+
+	ProcessActivationQueue();
+
+	// Nothing is casting, the requests left are waiting on abilities that cannot run yet
+	// they should not delay the new one
+	if (ActivationQueueDepth <= 0 || !IsCasting()) {
+		ClearActivationQueue();
+		return TryActivateAbility(Handle, true);
+	}
+
+	// Pressing the same ability again only refreshes its timestamp
+	ActivationQueue.RemoveAll([Handle](FGKQueuedActivation const& Queued) { return Queued.Handle == Handle; });
+
+	if (ActivationQueue.Num() >= ActivationQueueDepth) {
+		ActivationQueue.RemoveAt(0, ActivationQueue.Num() - ActivationQueueDepth + 1, false);
+	}
+
+	ActivationQueue.Add({Handle, GetQueueTime()});
+	return true;
+}
+
+void UGKAbilitySystemComponent::ClearActivationQueue() { ActivationQueue.Reset(); }
+
+bool UGKAbilitySystemComponent::IsCasting() const {
+	for (FGameplayAbilitySpec const& Spec: ActivatableAbilities.Items) {
+		if (!Spec.IsActive()) {
+			continue;
+		}
+
+		for (UGameplayAbility* Instance: Spec.GetAbilityInstances()) {
+			UGKGameplayAbility* Ability = Cast<UGKGameplayAbility>(Instance);
+
+			if (Ability != nullptr && Ability->IsCasting()) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+float UGKAbilitySystemComponent::GetQueueTime() const {
+	UWorld* World = GetWorld();
+	return World != nullptr ? World->GetTimeSeconds() : 0.f;
+}
+
+bool UGKAbilitySystemComponent::IsReadyToActivate(FGameplayAbilitySpecHandle Handle) const {
+	FGameplayAbilitySpec const* Spec = FindAbilitySpecFromHandle(Handle);
+
+	// Instanced abilities need to end before they can be activated again
+	if (Spec == nullptr || Spec->Ability == nullptr || Spec->IsActive()) {
+		return false;
+	}
+
+	// Check the same object GAS checks when activating, instanced abilities hold their own state
+	UGameplayAbility const* Ability = Spec->GetPrimaryInstance() ? Spec->GetPrimaryInstance() : Spec->Ability;
+	return Ability->CanActivateAbility(Handle, AbilityActorInfo.Get());
+}
+
+void UGKAbilitySystemComponent::ScheduleActivationQueue() {
+	UWorld* World = GetWorld();
+
+	if (ActivationQueue.Num() == 0 || World == nullptr) {
+		return;
+	}
+
+	// The ability that notified us is still in the middle of its update
+	World->GetTimerManager().SetTimerForNextTick(this, &UGKAbilitySystemComponent::ProcessActivationQueue);
+}
+
+void UGKAbilitySystemComponent::ProcessActivationQueue() {
+	float Now = GetQueueTime();
+
+	ActivationQueue.RemoveAll([this, Now](FGKQueuedActivation const& Queued) {
+		return Now - Queued.Time > ActivationBufferWindow;
+	});
+
+	// Activate in order until an ability starts casting,
+	// a request that cannot run yet is kept until it expires
+	while (ActivationQueue.Num() > 0 && !IsCasting()) {
+		FGameplayAbilitySpecHandle Handle = ActivationQueue[0].Handle;
+
+		// Nothing else might end to process the queue again, check on the next tick
+		if (!IsReadyToActivate(Handle)) {
+			ScheduleActivationQueue();
+			return;
+		}
+
+		ActivationQueue.RemoveAt(0, 1, false);
+		TryActivateAbility(Handle, true);
+	}
+}
+
+void UGKAbilitySystemComponent::NotifyAbilityEnded(FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability, bool bWasCancelled) {
+	Super::NotifyAbilityEnded(Handle, Ability, bWasCancelled);
+	ScheduleActivationQueue();
+}
+
 // this cannot work since we need to be able to instantiate blueprint classes
 TSubclassOf<AGKAbilityTarget_Actor> UGKAbilitySystemComponent::GetAbilityTarget_ActorClass(EGK_TargetingMode Mode) {
 	switch (Mode) {
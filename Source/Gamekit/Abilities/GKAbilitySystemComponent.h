@@ -15,6 +15,13 @@ class UGKGameplayAbility;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FGKAbilityFailedDelegate, const UGameplayAbility*, Ability, const FGameplayTagContainer&, FailureReason);
 
+//! Activation requested while another ability was casting
+struct FGKQueuedActivation
+{
+	FGameplayAbilitySpecHandle Handle;
+	float                      Time;
+};
+
 /**
  *
  */
@@ -33,6 +40,9 @@ public:
 	//! Used to receive the Granted ability through network
 	void OnGiveAbility(FGameplayAbilitySpec& AbilitySpec) override;
 
+	//! Spawn the projectiles of the ability ahead of time (FGKAbilityStatic::ProjectilePoolSize)
+	void PrewarmProjectiles(FGameplayAbilitySpec& AbilitySpec);
+
 	UFUNCTION(BlueprintCallable)
 	bool IsInitialized() const;
 
@@ -65,6 +75,42 @@ public:
 	UFUNCTION(Client, Reliable)
 	void ClientLevelUpAbility_Result(FGameplayAbilitySpecHandle Handle, int Level);
 
+	// Action Queue
+	// ------------
+	// Activations requested while an ability is casting are buffered and run as soon as
+	// the cast point is reached or the ability ends, instead of failing.
+	// The queue lives on the machine that received the input so retries do not send RPCs
+
+	//! Activate the ability now, or queue it if an ability is casting
+	//! Returns false if the ability could not be activated nor queued
+	UFUNCTION(BlueprintCallable, Category = Abilities)
+	bool TryActivateAbilityQueued(FGameplayAbilitySpecHandle Handle);
+
+	//! Drop the buffered activations
+	UFUNCTION(BlueprintCallable, Category = Abilities)
+	void ClearActivationQueue();
+
+	//! True if an ability did not reach its cast point yet
+	//! Non instanced abilities cannot track their cast and never count as casting
+	UFUNCTION(BlueprintPure, Category = Abilities)
+	bool IsCasting() const;
+
+	//! Run the buffered activations on the next tick
+	void ScheduleActivationQueue();
+
+	//! Run the buffered activations that can be activated
+	void ProcessActivationQueue();
+
+	void NotifyAbilityEnded(FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability, bool bWasCancelled) override;
+
+	//! Time in seconds during which a buffered activation is kept
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Abilities|Queue")
+	float ActivationBufferWindow = 0.5f;
+
+	//! Maximum number of buffered activations, the oldest is dropped when full; 0 disables the queue
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Abilities|Queue")
+	int32 ActivationQueueDepth = 1;
+
 // protected:
 	bool Initialized;
 
@@ -77,6 +123,13 @@ protected:
 
 	static TSubclassOf<AGKAbilityTarget_Actor> GetAbilityTarget_ActorClass(EGK_TargetingMode Mode);
 
+	TArray<FGKQueuedActivation> ActivationQueue;
+
+	float GetQueueTime() const;
+
+	//! The ability could be activated right now, without triggering the failure callbacks
+	bool IsReadyToActivate(FGameplayAbilitySpecHandle Handle) const;
+
 public:
 	AGKAbilityTarget_Actor* GetAbilityTarget_Actor(TSubclassOf<AGKAbilityTarget_Actor> AbilityTarget_ActorClass);
 
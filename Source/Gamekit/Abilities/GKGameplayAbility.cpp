@@ -17,9 +17,13 @@
 #include "Abilities/GKTargetType.h"
 #include "Abilities/GKAbilitySystemGlobals.h"
 #include "Abilities/GKCastPointAnimNotify.h"
+#include "Projectiles/GKAOEActor.h"
 #include "Projectiles/GKProjectile.h"
+#include "Projectiles/GKProjectilePool.h"
 #include "Characters/GKCharacter.h"
 #include "Controllers/GKPlayerController.h"
+#include "Utilities/GKCurveCache.h"
+#include "Utilities/GKDataTableRegistry.h"
 
 
 UGKGameplayEffectDyn::UGKGameplayEffectDyn(const FObjectInitializer& ObjectInitializer)
@@ -36,6 +40,7 @@ UGKGameplayAbility::UGKGameplayAbility() {
 
 	Immediate = false;
 	AbilityStatic = nullptr;
+	AbilityStaticRevision = 0;
 
 	CooldownEffectInstance = nullptr;
 	CostEffectInstance = nullptr;
@@ -44,8 +49,13 @@ UGKGameplayAbility::UGKGameplayAbility() {
 void UGKGameplayAbility::PostInitProperties() {
 	Super::PostInitProperties();
 
+	// Class defaults still load, GAS checks cooldown and cost on them when
+	// there is no primary instance, the effects are shared through the registry
+	if (HasAnyFlags(RF_ArchetypeObject) && !HasAnyFlags(RF_ClassDefaultObject)) {
+		return;
+	}
+
 	if (AbilityDataTable && AbilityRowName.IsValid()) {
-		UE_LOG(LogGamekit, Warning, TEXT("Loading From DataTable"));
 		OnDataTableChanged_Native();
 	}
 }
@@ -53,24 +63,30 @@ void UGKGameplayAbility::PostInitProperties() {
 void UGKGameplayAbility::OnDataTableChanged_Native() {
 	// Reset Cache
 	AbilityStatic = nullptr;
-	bool Valid = false;
-
-	FGKAbilityStatic* AbilityStaticOut = GetAbilityStatic();
+	AbilityStaticRevision = 0;
 
-	if (!AbilityStaticOut) {
-		AbilityStatic = nullptr;
-	}
+	GetAbilityStatic();
 }
 
 void UGKGameplayAbility::LoadFromDataTable(FGKAbilityStatic& AbilityDef) {
-	UE_LOG(LogGamekit, Warning, TEXT("Init Ability from table %s"), *AbilityDef.Name.ToString());
+	UE_LOG(LogGamekit, Verbose, TEXT("Init Ability from table %s"), *AbilityDef.Name.ToString());
+
+	// The effects only depend on the row, every instance of the row shares them
+	FGKDataTableRegistry& Registry = FGKDataTableRegistry::Get();
 
-	CooldownEffectInstance = NewCooldownEffectFromConfig(AbilityDef.Cooldown);
-	CostEffectInstance = NewCostEffectFromConfig(AbilityDef.Cost);
+	CooldownEffectInstance = Registry.FindOrAddDerived<UGameplayEffect>(AbilityDataTable, AbilityRowName, TEXT("Cooldown"), [&]() {
+		return NewCooldownEffectFromConfig(AbilityDef.Cooldown);
+	});
+
+	CostEffectInstance = Registry.FindOrAddDerived<UGameplayEffect>(AbilityDataTable, AbilityRowName, TEXT("Cost"), [&]() {
+		return NewCostEffectFromConfig(AbilityDef.Cost);
+	});
 }
 
 FGKAbilityStatic* UGKGameplayAbility::GetAbilityStatic() {
-	if (AbilityStatic) {
+	FGKDataTableRegistry& Registry = FGKDataTableRegistry::Get();
+
+	if (AbilityStatic && AbilityStaticRevision == Registry.GetRevision()) {
 		return AbilityStatic;
 	}
 
@@ -78,18 +94,15 @@ FGKAbilityStatic* UGKGameplayAbility::GetAbilityStatic() {
 		return nullptr;
 	}
 
-	// we do not have a cached value
-	if (!AbilityStatic) {
-		AbilityStatic = AbilityDataTable->FindRow<FGKAbilityStatic>(AbilityRowName, TEXT("Ability"), true);
+	// The row is shared by every instance, reload only if it is new or its table changed
+	FGKAbilityStatic* Row = Registry.FindRow<FGKAbilityStatic>(AbilityDataTable, AbilityRowName, TEXT("Ability"));
+	bool bReload = Row != AbilityStatic || Registry.GetTableRevision(AbilityDataTable) > AbilityStaticRevision;
 
-		if (AbilityStatic != nullptr) {
-			LoadFromDataTable(*AbilityStatic);
-		}
+	AbilityStatic = Row;
+	AbilityStaticRevision = Registry.GetRevision();
 
-		// Listen to data table change
-		if (!AbilityDataTable->OnDataTableChanged().IsBoundToObject(this)) {
-			AbilityDataTable->OnDataTableChanged().AddUObject(this, &UGKGameplayAbility::OnDataTableChanged_Native);
-		}
+	if (AbilityStatic != nullptr && bReload) {
+		LoadFromDataTable(*AbilityStatic);
 	}
 
 	return AbilityStatic;
@@ -226,8 +239,8 @@ void UGKGameplayAbility::OnAbilityTargetAcquired(const FGameplayAbilityTargetDat
 
 	// Warning Animation is already playing
 	// user need to cancel backswing to be able to cast before
-	// animation ends
-	// TODO: when implementing Action Queue handle that
+	// animation ends, activations requested before the cast point
+	// are queued by UGKAbilitySystemComponent::TryActivateAbilityQueued
 	if (IsValid(AnimTask)) {
 		AnimTask->EndTask();
 		// return;
@@ -274,19 +287,30 @@ void UGKGameplayAbility::OnAbilityTargetAcquired(const FGameplayAbilityTargetDat
 	AnimTask->EventReceived.AddDynamic(this, &UGKGameplayAbility::OnAbilityAnimationEvent);
 
 	// Run
+	Casting = true;
 	AnimTask->Activate();
 }
 
 void UGKGameplayAbility::OnAbilityAnimationBlendOut(FGameplayTag EventTag, FGameplayEventData EventData) {
+	Casting = false;
 	K2_EndAbility();
 	AnimTask = nullptr;
 }
 
 void UGKGameplayAbility::OnAbilityAnimationAbort(FGameplayTag EventTag, FGameplayEventData EventData) {
+	Casting = false;
 	K2_CancelAbility();
 	AnimTask = nullptr;
 }
 
+void UGKGameplayAbility::NotifyCastPointReached() {
+	auto ASC = Cast<UGKAbilitySystemComponent>(GetAbilitySystemComponentFromActorInfo());
+
+	if (ASC) {
+		ASC->ScheduleActivationQueue();
+	}
+}
+
 bool UGKGameplayAbility::K2_CheckTagRequirements(FGameplayTagContainer& RelevantTags) {
 	UAbilitySystemComponent* const AbilitySystemComponent = CurrentActorInfo->AbilitySystemComponent.Get();
 	return CheckTagRequirements(*AbilitySystemComponent, &RelevantTags);
@@ -316,6 +340,7 @@ bool UGKGameplayAbility::CanActivateAbility(const FGameplayAbilitySpecHandle Han
 void UGKGameplayAbility::CancelAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo, bool bReplicateCancelAbility) {
 	Super::CancelAbility(Handle, ActorInfo, ActivationInfo, bReplicateCancelAbility);
 
+	Casting = false;
 	if (AnimTask) {
 		AnimTask->ExternalCancel();
 	}
@@ -405,8 +430,12 @@ void UGKGameplayAbility::OnAbilityAnimationEvent(FGameplayTag EventTag, FGamepla
 	// making the bug less likely to happen
 	// 
 	// Note: cooldowns will prevent the bug from happening
+	Casting = false;
+
 	if (!K2_HasAuthority()) {
 		// needs to wait for CommitAbility being replicated on client and then spawn the projectile everywhere
+		// the backswing can be interrupted by a queued ability from now on
+		NotifyCastPointReached();
 		return;
 	}
 
@@ -418,6 +447,7 @@ void UGKGameplayAbility::OnAbilityAnimationEvent(FGameplayTag EventTag, FGamepla
 
 	if (K2_CommitAbility()) {
 		SpawnProjectile(EventTag, EventData);
+		SpawnAreaOfEffect(EventTag, EventData);
 		K2_EndAbility();
 		return;
 	}
@@ -568,7 +598,8 @@ UGameplayEffect* UGKGameplayAbility::NewCooldownEffectFromConfig(TArray<float>&
 
 	auto RowName = FName(FString("Cooldown.") + AbilityStatic->Name.ToString());
 
-	UGameplayEffect* CooldownEffect = NewObject<UGKGameplayEffectDyn>(this /*, TEXT("GameplayEffect.Cooldown") */);
+	// Shared by the instances of the ability, not owned by any of them
+	UGameplayEffect* CooldownEffect = NewObject<UGKGameplayEffectDyn>(GetTransientPackage() /*, TEXT("GameplayEffect.Cooldown") */);
 	CooldownEffect->DurationPolicy = EGameplayEffectDurationType::HasDuration;
 
 	auto ScalableDuration = GenerateCurveDataFromArray(RowName, Durations, true, false);
@@ -589,7 +620,7 @@ UGameplayEffect* UGKGameplayAbility::NewCostEffectFromConfig(FGKAbilityCost& Con
 
 	auto RowName = FName(FString("Cost.") + AbilityStatic->Name.ToString());
 
-	UGameplayEffect* CostEffect = NewObject<UGKGameplayEffectDyn>(this /*, TEXT("GameplayEffect.Cost")*/);
+	UGameplayEffect* CostEffect = NewObject<UGKGameplayEffectDyn>(GetTransientPackage() /*, TEXT("GameplayEffect.Cost")*/);
 	CostEffect->DurationPolicy = EGameplayEffectDurationType::Instant;
 	CostEffect->Modifiers.SetNum(1);
 
@@ -649,28 +680,20 @@ FScalableFloat UGKGameplayAbility::GenerateCurveDataFromArray(FName RowName, TAr
 		return FScalableFloat(BaseValue);
 	}
 
-	FSimpleCurve& Curve = Table->AddSimpleCurve(RowName);
-
-	for(int i = 1 - int(ValuesAreFinal); i < Values.Num(); i++){
-		float v;
-
-		if (ValuesAreFinal) {
-			v = Values[i] / Values[0];
-		}
-		else {
-			v = Values[i];
-		}
-
-		Curve.AddKey(i + 1, v);
+	// Abilities with the same progression share the curve, the table can be built before cooking
+	FName CurveName = FGKCurveCache::FindOrAddLevelCurve(Table, Values, ValuesAreFinal);
+	if (CurveName == NAME_None) {
+		UE_LOG(LogGamekit, Warning, TEXT("Could not generate curve data %s"), *RowName.ToString());
+		return FScalableFloat();
 	}
 
-	float BaseValue = Values[0];
+	float BaseValue = FGKCurveCache::GetLevelCurveBase(Values, ValuesAreFinal);
 	if (Cost) {
 		BaseValue = -abs(BaseValue);
 	}
 
 	FScalableFloat ScalableFloat(BaseValue);
-	ScalableFloat.Curve.RowName = RowName;
+	ScalableFloat.Curve.RowName = CurveName;
 	ScalableFloat.Curve.CurveTable = Table;
 	return ScalableFloat;
 }
@@ -706,22 +729,18 @@ void UGKGameplayAbility::SpawnProjectile(FGameplayTag EventTag, FGameplayEventDa
 	// > actor down to him.We could potentially also use this to do predictive actor spawning / reconciliation.
 	//
 	// Pending UE4 does it we might have to do it here
-	FActorSpawnParameters SpawnInfo;
-	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-	SpawnInfo.Owner = Pawn;
-	SpawnInfo.Instigator = Pawn;
-	SpawnInfo.bDeferConstruction = true;
-
 	auto ActorRot = Actor->GetActorRotation();
 	FTransform Transform;
 	Transform.SetRotation(FQuat(ActorRot));
 	Transform.SetLocation(Actor->GetActorLocation() + Actor->GetActorForwardVector() * 64.0f);
 
-	auto ProjectileInstance = Actor->GetWorld()->SpawnActor<AGKProjectile>(
-		Data->ProjectileActorClass,
-		Transform,
-		SpawnInfo
-	);
+	// Rapid fire abilities reuse their projectiles instead of spawning new actors
+	auto Pool = Actor->GetWorld()->GetSubsystem<UGKProjectilePoolSubsystem>();
+	auto ProjectileInstance = Pool->Acquire(Data->ProjectileActorClass, Transform, Pawn);
+
+	if (!ProjectileInstance) {
+		return;
+	}
 
 	ProjectileInstance->Direction = ActorRot.Vector();
 	ProjectileInstance->Speed = Data->ProjectileSpeed;
@@ -732,7 +751,7 @@ void UGKGameplayAbility::SpawnProjectile(FGameplayTag EventTag, FGameplayEventDa
 	// The attachment is probably Character/class/Skeleton defined
 	// ...
 
-	UGameplayStatics::FinishSpawningActor(ProjectileInstance, Transform);
+	Pool->Start(ProjectileInstance, Transform);
 
 	// we need a multi-cast here to tell people we are ready to make the Projectile move
 	// this would assume that the network works with a queue so given we modified the properties
@@ -741,6 +760,54 @@ void UGKGameplayAbility::SpawnProjectile(FGameplayTag EventTag, FGameplayEventDa
 	// ProjectileInstance->Ready()
 }
 
+void UGKGameplayAbility::SpawnAreaOfEffect(FGameplayTag EventTag, FGameplayEventData EventData) {
+	FGKAbilityStatic* Data = GetAbilityStatic();
+
+	if (!Data || !Data->AOEActorClass) {
+		return;
+	}
+
+	auto ActorInfo = GetCurrentActorInfo();
+	auto Actor = ActorInfo->AvatarActor;
+	auto Pawn = Cast<APawn>(Actor.Get());
+
+	// Centered on the targeted location, or on the caster
+	FVector Location = Actor->GetActorLocation();
+	auto& TargetData = EventData.TargetData;
+
+	if (TargetData.Num() > 0) {
+		auto Target = TargetData.Get(0);
+
+		if (Target->HasHitResult()) {
+			Location = Target->GetHitResult()->Location;
+		}
+		else if (Target->HasEndPoint()) {
+			Location = Target->GetEndPoint();
+		}
+	}
+
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnInfo.Owner = Pawn;
+	SpawnInfo.Instigator = Pawn;
+	SpawnInfo.bDeferConstruction = true;
+
+	FTransform Transform(Actor->GetActorRotation(), Location);
+
+	auto AOEInstance = Actor->GetWorld()->SpawnActor<AActor>(Data->AOEActorClass, Transform, SpawnInfo);
+
+	if (!AOEInstance) {
+		return;
+	}
+
+	if (auto AOE = Cast<AGKAOEActor>(AOEInstance)) {
+		AOE->InitializeFromAbilityData(*Data);
+		AOE->GameplayEffects = MakeEffectContainerSpec(EventTag, EventData);
+	}
+
+	UGameplayStatics::FinishSpawningActor(AOEInstance, Transform);
+}
+
 UAnimMontage* UGKGameplayAbility::GetAnimation() {
 	if (AnimMontages.Animations.Num() > 0) {
 		return AnimMontages.Sample();
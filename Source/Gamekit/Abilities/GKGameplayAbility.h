@@ -102,7 +102,7 @@ public:
 	//! C++ version avoid to copy the entire struct
 	FGKAbilityStatic* GetAbilityStatic();
 
-	//! Called everytime the DataTable is modified, refresh the cached lookup
+	//! Drop the cached lookup and load the row again
 	UFUNCTION()
 	void OnDataTableChanged_Native();
 
@@ -116,6 +116,9 @@ public:
 	//! Cached lookup, do not use!
 	FGKAbilityStatic* AbilityStatic;
 
+	//! FGKDataTableRegistry revision AbilityStatic was resolved at
+	uint32 AbilityStaticRevision;
+
 	// Animations
 	// ----------
 public:
@@ -150,7 +153,17 @@ public:
 	UPROPERTY()
 	class UGKAbilityTask_PlayMontageAndWaitForEvent* AnimTask;
 
+	//! True while the animation has not reached the cast point
+	//! activations requested during that time are buffered by the UGKAbilitySystemComponent
+	UFUNCTION(BlueprintPure, Category = Ability)
+	bool IsCasting() const { return Casting; }
+
 protected:
+	bool Casting = false;
+
+	//! Let the queued activations run
+	void NotifyCastPointReached();
+
 	//! New animation is taking over, make sure the ability is in a clean state for next call
 	UFUNCTION()
 	void OnAbilityAnimationBlendOut(FGameplayTag EventTag, FGameplayEventData EventData);
@@ -185,6 +198,9 @@ public:
 	// Projectile
 	void SpawnProjectile(FGameplayTag EventTag, FGameplayEventData EventData);
 
+	// Area of effect, spawns FGKAbilityStatic::AOEActorClass at the target location
+	void SpawnAreaOfEffect(FGameplayTag EventTag, FGameplayEventData EventData);
+
 public:
 	// TODO: remove this
 	/** Map of gameplay tags to gameplay effect containers */
@@ -246,6 +262,7 @@ public:
 	//! but ScalableFloat expects a dedicated table
 	//! if ValuesAreFinal == 1 then the Curve is the result of Values[0] * Values[Level]
 	//! if ValuesAreFinal == 0 then the first value is the base & the subsequent values are levels multiplier
+	//! The curve is shared with every ability using the same values (see FGKCurveCache)
 	FScalableFloat GenerateCurveDataFromArray(FName prefix, TArray<float>& Values, bool ValuesAreFinal, bool Cost);
 
 	// Dynamic Init
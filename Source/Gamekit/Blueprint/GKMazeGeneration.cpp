@@ -2,7 +2,11 @@
 
 #include "Gamekit/Blueprint/GKMazeGeneration.h"
 
-#include "Kismet/KismetMathLibrary.h"
+#include "Gamekit.h"
+
+#include "Components/InstancedStaticMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+
 #include "Math/IntVector.h"
 #include "Math/RandomStream.h"
 
@@ -16,188 +20,392 @@ int32_t GetX(uint64_t k) {
     return int(y);
 }
 
-void UGKMazeGeneration::RandomWall(int GridX, int GridY, float Density, TArray<FIntVector> &Walls) {
+void UGKMazeGeneration::RandomWall(int GridX, int GridY, float Density, TArray<FIntVector> &Walls, int Seed) {
     int           HalfX = GridX / 2;
     int           HalfY = GridY / 2;
-    FRandomStream Stream(0);
+    FRandomStream Stream(Seed);
 
     for (int i = -HalfX; i <= HalfX; i++) {
         for (int j = -HalfY; j <= HalfY; j++) {
             int X = i * GridX;
             int Y = j * GridY;
 
-            if (UKismetMathLibrary::RandomFloatFromStream(Stream) < Density) {
+            if (Stream.FRand() < Density) {
                 Walls.Emplace(X, Y, 0);
             }
         }
     }
 }
 
-FIntVector NOFFSET[6] = {
-    FIntVector(-2, 0, 0), FIntVector(+2, 0, 0), FIntVector(0, -2, 0),
-    FIntVector(0, +2, 0), FIntVector(0, 0, -2), FIntVector(0, 0, +2),
-};
+void FGKMazeGrid::Init(int32 InSizeX, int32 InSizeY) {
+    SizeX = FMath::Max(InSizeX, 0);
+    SizeY = FMath::Max(InSizeY, 0);
 
-template <typename T>
-struct T3DArray {
-    T3DArray(int row, int col, int depth = 1): Row(row), Col(col), Depth(depth) {
-        Data.Init(T(), Row * Col * Depth);
-    }
+    Words.Reset();
+    Words.SetNumZeroed((SizeX * SizeY + 63) / 64);
+}
 
-    T &operator()(int r, int c, int d = 0) { return Data[c + r * Col + d * (Col * Row)]; }
+int32 FGKMazeGrid::NumOpen() const {
+    int32 Count = 0;
+    for (uint64 Word: Words) {
+        Count += FMath::CountBits(Word);
+    }
+    return Count;
+}
 
-    T &operator()(FIntVector v) { return Data[v.Y + v.X * Col + v.Z * (Col * Row)]; }
+void FGKMazeGrid::ToWalls(TArray<FIntVector> &Walls) const {
+    int HalfX = SizeX / 2;
+    int HalfY = SizeY / 2;
 
-    TArray<FIntVector> GetNeighbours(FIntVector v) {
-        TArray<FIntVector> Result;
-        Result.Reserve(4);
+    Walls.Reserve(Walls.Num() + Num() - NumOpen());
 
-        for (int i = 0; i < 4; i++) {
-            auto n = v + NOFFSET[i];
-            if (n.X < 0 || n.X >= Row) {
-                continue;
+    int32 Index = 0;
+    for (int i = 0; i < SizeX; i++) {
+        for (int j = 0; j < SizeY; j++, Index++) {
+            if (!IsOpen(Index)) {
+                Walls.Emplace((i - HalfX) * SizeX, (j - HalfY) * SizeY, 0);
             }
-            if (n.Y < 0 || n.Y >= Col) {
-                continue;
-            }
-            if (n.Z < 0 || n.Z >= Depth) {
-                continue;
-            }
-            Result.Add(NOFFSET[i]);
         }
-        return Result;
     }
+}
 
-    TArray<T> &GetData() { return Data; }
+bool FGKMazeGrid::FromWalls(int32 GridX, int32 GridY, TArray<FIntVector> const &Walls, FIntPoint &Origin) {
+    if (GridX == 0 || GridY == 0 || Walls.Num() == 0) {
+        Init(0, 0);
+        return false;
+    }
 
-    private:
-    int       Row;
-    int       Col;
-    int       Depth;
-    TArray<T> Data;
-};
+    FIntPoint Min(MAX_int32, MAX_int32);
+    FIntPoint Max(MIN_int32, MIN_int32);
 
-#define VISITED 1
-#define WALL    0
+    for (FIntVector const &Wall: Walls) {
+        FIntPoint Cell(Wall.X / GridX, Wall.Y / GridY);
+        Min = FIntPoint(FMath::Min(Min.X, Cell.X), FMath::Min(Min.Y, Cell.Y));
+        Max = FIntPoint(FMath::Max(Max.X, Cell.X), FMath::Max(Max.Y, Cell.Y));
+    }
 
-void UGKMazeGeneration::RandomizedDepthFirstSearch(int GridX, int GridY,
-                                                   TArray<FIntVector> &Walls) {
-    TArray<FIntVector> Stack;
+    Init(Max.X - Min.X + 1, Max.Y - Min.Y + 1);
+    for (uint64 &Word: Words) {
+        Word = ~uint64(0);
+    }
+
+    // Keep the bits past the last cell closed so NumOpen stays exact
+    if (Num() & 63) {
+        Words.Last() = (uint64(1) << (Num() & 63)) - 1;
+    }
+
+    for (FIntVector const &Wall: Walls) {
+        Close(IndexOf(Wall.X / GridX - Min.X, Wall.Y / GridY - Min.Y));
+    }
+
+    Origin = Min;
+    return true;
+}
 
-    Stack.Reserve(GridX * GridY);
-    T3DArray<int> Grid(GridX, GridY);
-    FRandomStream Stream(0);
+void UGKMazeGeneration::DepthFirstSearch(FGKMazeGrid &Grid, FRandomStream &Stream, TArray<int32> &Stack, int32 Start) {
+    int32 const SizeX = Grid.SizeX;
+    int32 const SizeY = Grid.SizeY;
+
+    if (SizeX <= 0 || SizeY <= 0) {
+        return;
+    }
+
+    // Stack holds a path of cells sharing the parity of the initial cell
+    Stack.Reset();
+    Stack.Reserve(((SizeX + 1) / 2) * ((SizeY + 1) / 2));
 
     // Choose the initial cell,
-    int X = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, GridX - 1, Stream);
-    int Y = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, GridY - 1, Stream);
+    int X = 0;
+    int Y = 0;
+
+    if (Start == INDEX_NONE) {
+        X = Stream.RandRange(0, SizeX - 1);
+        Y = Stream.RandRange(0, SizeY - 1);
+        Start = Grid.IndexOf(X, Y);
+    }
 
-    auto Cell  = FIntVector(X, Y, 0);
-    Grid(Cell) = VISITED; // mark it as visited
-    Stack.Push(Cell);     // push it to the stack
+    int32 Cell = Start;
+    Grid.Open(Cell);
+    Stack.Push(Cell);
+
+    // Same order as T3DArray::GetNeighbours so the stream is consumed identically
+    int32 const Offsets[4] = {-2 * SizeY, +2 * SizeY, -2, +2};
 
     while (Stack.Num() > 0) {
-        Cell = Stack.Pop(false); // Pop a cell from the stack and make it a current cell
+        Cell = Stack.Last();
+        X    = Cell / SizeY;
+        Y    = Cell - X * SizeY;
 
-        X = Cell.X;
-        Y = Cell.Y;
+        int32 Neighbours[4];
+        int32 Count = 0;
 
-        TArray<FIntVector> Neighbours;
-        for (auto &n: Grid.GetNeighbours(Cell)) {
-            if (Grid(Cell + n) == VISITED) {
-                continue;
-            }
-            Neighbours.Add(n);
+        if (X >= 2 && !Grid.IsOpen(Cell + Offsets[0])) {
+            Neighbours[Count++] = Offsets[0];
+        }
+        if (X + 2 < SizeX && !Grid.IsOpen(Cell + Offsets[1])) {
+            Neighbours[Count++] = Offsets[1];
+        }
+        if (Y >= 2 && !Grid.IsOpen(Cell + Offsets[2])) {
+            Neighbours[Count++] = Offsets[2];
+        }
+        if (Y + 2 < SizeY && !Grid.IsOpen(Cell + Offsets[3])) {
+            Neighbours[Count++] = Offsets[3];
         }
 
-        if (Neighbours.Num() <= 0) {
+        // Dead end, backtrack
+        if (Count == 0) {
+            Stack.Pop(false);
             continue;
         }
 
-        // Keep current cell so we can backtrack to it
-        Stack.Push(Cell);
-
         // Select a neighboor to continue our exploration
-        auto i = UKismetMathLibrary::RandomIntegerInRange(0, Neighbours.Num() - 1);
-        auto n = Cell + Neighbours[i];
-        auto w = Cell + Neighbours[i] / 2;
-
-        Grid(w) = VISITED;
-        Grid(n) = VISITED;
-        Stack.Push(n); // Push it to the stack
-    }
-
-    int HalfX = GridX / 2;
-    int HalfY = GridY / 2;
-    for (int i = 0; i < GridX; i++) {
-        for (int j = 0; j < GridY; j++) {
-            if (Grid(i, j) == WALL) {
-                X = (i - HalfX) * GridX;
-                Y = (j - HalfY) * GridY;
-                Walls.Emplace(X, Y, 0);
+        int32 Offset = Neighbours[Stream.RandRange(0, Count - 1)];
+
+        Grid.Open(Cell + Offset / 2);
+        Grid.Open(Cell + Offset);
+        Stack.Push(Cell + Offset);
+    }
+}
+
+void UGKMazeGeneration::RandomizedDepthFirstSearch(int GridX, int GridY,
+                                                   TArray<FIntVector> &Walls, int Seed) {
+    FGKMazeGrid   Grid(GridX, GridY);
+    TArray<int32> Stack;
+    FRandomStream Stream(Seed);
+
+    DepthFirstSearch(Grid, Stream, Stack);
+    Grid.ToWalls(Walls);
+}
+
+bool UGKMazeGeneration::Wilson(FGKMazeGrid &Grid, FRandomStream &Stream, TArray<uint8> &Walk, int32 Coverage, int32 MaxSteps) {
+    int32 const SizeX = Grid.SizeX;
+    int32 const SizeY = Grid.SizeY;
+
+    if (SizeX <= 0 || SizeY <= 0) {
+        return true;
+    }
+
+    // Choose the root of the tree, maze cells share its parity
+    int X = Stream.RandRange(0, SizeX - 1);
+    int Y = Stream.RandRange(0, SizeY - 1);
+    int PX = X & 1;
+    int PY = Y & 1;
+
+    int32 const CellsX = (SizeX - PX + 1) / 2;
+    int32 const CellsY = (SizeY - PY + 1) / 2;
+    int32 const Target = int32((int64(CellsX) * CellsY * FMath::Clamp(Coverage, 0, 100) + 99) / 100);
+
+    Grid.Open(Grid.IndexOf(X, Y));
+    int32 InTree = 1;
+
+    // Direction taken when the walk last left a cell, following them from the start
+    // of the walk gives the loop erased path
+    Walk.SetNumUninitialized(Grid.Num(), false);
+
+    int32 const Offsets[4] = {-2 * SizeY, +2 * SizeY, -2, +2};
+    int32       Steps      = 0;
+    int32       Cursor     = 0; // Next maze cell to scan for a walk start
+
+    while (InTree < Target) {
+        // Start from a random cell, fall back to the next one in scan order
+        // when the tree already covers most of the maze
+        int32 Start = INDEX_NONE;
+
+        for (int Try = 0; Try < 4 && Start == INDEX_NONE; Try++) {
+            int32 Candidate = Stream.RandRange(0, CellsX * CellsY - 1);
+            int32 Index     = Grid.IndexOf(PX + 2 * (Candidate / CellsY), PY + 2 * (Candidate % CellsY));
+
+            if (!Grid.IsOpen(Index)) {
+                Start = Index;
             }
         }
+
+        while (Start == INDEX_NONE && Cursor < CellsX * CellsY) {
+            int32 Index = Grid.IndexOf(PX + 2 * (Cursor / CellsY), PY + 2 * (Cursor % CellsY));
+            Cursor += 1;
+
+            if (!Grid.IsOpen(Index)) {
+                Start = Index;
+            }
+        }
+
+        if (Start == INDEX_NONE) {
+            break;
+        }
+
+        // Random walk until we hit the tree
+        int32 Cell = Start;
+        while (!Grid.IsOpen(Cell)) {
+            X = Cell / SizeY;
+            Y = Cell - X * SizeY;
+
+            uint8 Directions[4];
+            int32 Count = 0;
+
+            if (X >= 2) {
+                Directions[Count++] = 0;
+            }
+            if (X + 2 < SizeX) {
+                Directions[Count++] = 1;
+            }
+            if (Y >= 2) {
+                Directions[Count++] = 2;
+            }
+            if (Y + 2 < SizeY) {
+                Directions[Count++] = 3;
+            }
+
+            uint8 Direction = Directions[Stream.RandRange(0, Count - 1)];
+            Walk[Cell]      = Direction;
+            Cell += Offsets[Direction];
+
+            Steps += 1;
+            if (MaxSteps > 0 && Steps >= MaxSteps) {
+                return false;
+            }
+        }
+
+        // Commit the loop erased path
+        Cell = Start;
+        while (!Grid.IsOpen(Cell)) {
+            int32 Offset = Offsets[Walk[Cell]];
+
+            Grid.Open(Cell);
+            Grid.Open(Cell + Offset / 2);
+            InTree += 1;
+            Cell += Offset;
+        }
     }
+
+    return true;
 }
 
-// The stopping condition is probably not that great
-void WilsonWalk(int GridX, int GridY, int Stop, TArray<FIntVector> &Out) {
-    T3DArray<int> Grid(GridX, GridY);
-    FRandomStream Stream(0);
-    int           count = 0;
-
-    {
-        int  X     = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, GridX - 1, Stream);
-        int  Y     = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, GridY - 1, Stream);
-        auto Cell  = FIntVector(X, Y, 0);
-        Grid(Cell) = VISITED; // mark it as visited
-        count += 1;
-    }
-
-    int  X             = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, GridX - 1, Stream);
-    int  Y             = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, GridY - 1, Stream);
-    auto Starting      = FIntVector(X, Y, 0);
-    Grid(Starting)     = VISITED; // mark it as visited
-    auto Cell          = Starting;
-    auto pending_count = count + 1;
-
-    T3DArray<int> Pending = Grid;
-    do {
-        auto Neighbours = Grid.GetNeighbours(Cell);
-
-        auto i = UKismetMathLibrary::RandomIntegerInRange(0, Neighbours.Num() - 1);
-        Cell += Neighbours[i];
-        pending_count += 1;
-
-        // we found a a visited square
-        if (Grid(Cell) == VISITED) {
-            // persist the change
-            Grid  = Pending;
-            count = pending_count;
-
-            // Start a new walk
-            X        = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, GridX - 1, Stream);
-            Y        = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, GridY - 1, Stream);
-            Starting = FIntVector(X, Y, 0);
-            Grid(Starting) = VISITED; // mark it as visited
-            Cell           = Starting;
-        }
+void UGKMazeGeneration::RandomizedWilson(int GridX, int GridY, TArray<FIntVector> &Walls, int Seed, int Coverage, int MaxSteps) {
+    FGKMazeGrid   Grid(GridX, GridY);
+    TArray<uint8> Walk;
+    FRandomStream Stream(Seed);
 
-        // We made a loop with our own path, restart
-        if (Pending(Cell) == VISITED) {
-            // Reset our starting point
-            Grid(Starting) = WALL;
-            Pending        = Grid;
-            pending_count  = count;
-
-            // Start a new walk
-            X        = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, GridX - 1, Stream);
-            Y        = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, GridY - 1, Stream);
-            Starting = FIntVector(X, Y, 0);
-            Grid(Starting) = VISITED; // mark it as visited
-            Cell           = Starting;
-            continue;
+    if (!Wilson(Grid, Stream, Walk, Coverage, MaxSteps)) {
+        UE_LOG(LogGamekit, Warning, TEXT("Wilson maze stopped after %d steps, maze is incomplete"), MaxSteps);
+    }
+    Grid.ToWalls(Walls);
+}
+
+void UGKMazeGeneration::MergeWallGrid(FGKMazeGrid const &Grid, FIntPoint Origin, FIntPoint Spacing, TArray<FGKMazeWallBox> &Boxes) {
+    // Open cells and walls already merged are skipped
+    FGKMazeGrid Covered = Grid;
+
+    for (int i = 0; i < Grid.SizeX; i++) {
+        for (int j = 0; j < Grid.SizeY; j++) {
+            int32 Index = Grid.IndexOf(i, j);
+            if (Covered.IsOpen(Index)) {
+                continue;
+            }
+
+            // Extend along Y (contiguous in memory) then along X while the whole span is a wall
+            int32 SizeY = 1;
+            while (j + SizeY < Grid.SizeY && !Covered.IsOpen(Index + SizeY)) {
+                SizeY += 1;
+            }
+
+            int32 SizeX = 1;
+            while (i + SizeX < Grid.SizeX) {
+                int32 Row   = Grid.IndexOf(i + SizeX, j);
+                bool  bFull = true;
+
+                for (int32 k = 0; k < SizeY && bFull; k++) {
+                    bFull = !Covered.IsOpen(Row + k);
+                }
+
+                if (!bFull) {
+                    break;
+                }
+                SizeX += 1;
+            }
+
+            for (int32 x = 0; x < SizeX; x++) {
+                int32 Row = Grid.IndexOf(i + x, j);
+                for (int32 k = 0; k < SizeY; k++) {
+                    Covered.Open(Row + k);
+                }
+            }
+
+            FGKMazeWallBox &Box = Boxes.AddDefaulted_GetRef();
+            Box.Size   = FIntPoint(SizeX, SizeY);
+            Box.Center = FVector((Origin.X + i + (SizeX - 1) * 0.5f) * Spacing.X,
+                                 (Origin.Y + j + (SizeY - 1) * 0.5f) * Spacing.Y,
+                                 0.f);
+
+            FVector Extent = FVector(SizeX * Spacing.X, SizeY * Spacing.Y, 0.f) * 0.5f;
+            if (Extent.Y > Extent.X) {
+                Box.Extent   = FVector(Extent.Y, Extent.X, 0.f);
+                Box.Rotation = FRotator(0.f, 90.f, 0.f);
+            } else {
+                Box.Extent = Extent;
+            }
         }
+    }
+}
 
-    } while (int(float(count * 100) / float(GridX * GridY)) < Stop);
-}
\ No newline at end of file
+void UGKMazeGeneration::MergeWalls(int GridX, int GridY, TArray<FIntVector> const &Walls, TArray<FGKMazeWallBox> &Boxes) {
+    // Walls are placed every GridX x GridY units, find the cells they cover
+    FGKMazeGrid Grid;
+    FIntPoint   Origin;
+
+    if (Grid.FromWalls(GridX, GridY, Walls, Origin)) {
+        MergeWallGrid(Grid, Origin, FIntPoint(GridX, GridY), Boxes);
+    }
+}
+
+void UGKMazeGeneration::WallBoxTransforms(TArray<FGKMazeWallBox> const &Boxes, TArray<FTransform> &Transforms) {
+    Transforms.Reserve(Transforms.Num() + Boxes.Num());
+
+    // Scale in world axes, the rotation is not needed
+    for (FGKMazeWallBox const &Box: Boxes) {
+        Transforms.Emplace(FQuat::Identity, Box.Center, FVector(Box.Size.X, Box.Size.Y, 1.f));
+    }
+}
+
+void UGKMazeGeneration::AddWallInstances(UInstancedStaticMeshComponent *Instances, TArray<FGKMazeWallBox> const &Boxes) {
+    if (Instances == nullptr) {
+        return;
+    }
+
+    TArray<FTransform> Transforms;
+    WallBoxTransforms(Boxes, Transforms);
+    Instances->AddInstances(Transforms, false);
+}
+
+namespace {
+
+void BenchmarkMazes(TArray<FString> const &Args) {
+    int32 MaxSize = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 2048;
+
+    FGKMazeGrid   Grid;
+    TArray<int32> Stack;
+    TArray<uint8> Walk;
+
+    for (int32 Size = 128; Size <= MaxSize; Size *= 2) {
+        FRandomStream Stream(0);
+
+        Grid.Init(Size, Size);
+        double Start = FPlatformTime::Seconds();
+        UGKMazeGeneration::DepthFirstSearch(Grid, Stream, Stack);
+        double DFS = FPlatformTime::Seconds() - Start;
+
+        Grid.Init(Size, Size);
+        Start = FPlatformTime::Seconds();
+        UGKMazeGeneration::Wilson(Grid, Stream, Walk);
+        double Wilson = FPlatformTime::Seconds() - Start;
+
+        UE_LOG(LogGamekit, Display, TEXT("Maze %5d x %5d: DFS %8.2f ms, Wilson %8.2f ms"), Size, Size, DFS * 1000.0, Wilson * 1000.0);
+    }
+}
+
+FAutoConsoleCommand BenchmarkMazesCommand(
+    TEXT("Gamekit.Maze.Benchmark"),
+    TEXT("Time the maze generators on square grids from 128 up to the given size (default 2048)"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkMazes)
+);
+
+}
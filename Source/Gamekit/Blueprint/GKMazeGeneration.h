@@ -9,6 +9,68 @@
 
 #include "GKMazeGeneration.generated.h"
 
+struct FRandomStream;
+
+/** One bit per cell maze grid, a set bit is an open cell
+ *
+ * Cells are stored X major (X * SizeY + Y), the same layout as the previous
+ * int grid so generators visit cells in the same order.
+ */
+struct GAMEKIT_API FGKMazeGrid
+{
+	FGKMazeGrid() {}
+
+	FGKMazeGrid(int32 InSizeX, int32 InSizeY) { Init(InSizeX, InSizeY); }
+
+	//! Resize and close every cell, keeps the allocation when possible
+	void Init(int32 InSizeX, int32 InSizeY);
+
+	int32 IndexOf(int32 X, int32 Y) const { return X * SizeY + Y; }
+
+	bool IsOpen(int32 Index) const { return (Words[Index >> 6] >> (Index & 63)) & 1; }
+
+	void Open(int32 Index) { Words[Index >> 6] |= uint64(1) << (Index & 63); }
+
+	void Close(int32 Index) { Words[Index >> 6] &= ~(uint64(1) << (Index & 63)); }
+
+	int32 Num() const { return SizeX * SizeY; }
+
+	int32 NumOpen() const;
+
+	//! Append the closed cells as 1x1 walls centered on the origin
+	void ToWalls(TArray<FIntVector>& Walls) const;
+
+	//! Rebuild the grid covering 1x1 walls placed every GridX x GridY units, every other cell is open
+	//! Origin is the cell of the walls at index (0, 0), returns false if there are no walls
+	bool FromWalls(int32 GridX, int32 GridY, TArray<FIntVector> const& Walls, FIntPoint& Origin);
+
+	int32          SizeX = 0;
+	int32          SizeY = 0;
+	TArray<uint64> Words;
+};
+
+// Contiguous wall cells merged into a single box
+USTRUCT(BlueprintType)
+struct GAMEKIT_API FGKMazeWallBox
+{
+	GENERATED_BODY()
+
+	// Center of the box, in the same space as the 1x1 wall positions
+	UPROPERTY(BlueprintReadOnly, Category = "Procedural|Maze")
+	FVector Center = FVector::ZeroVector;
+
+	// Half size of the box, X is along its length
+	UPROPERTY(BlueprintReadOnly, Category = "Procedural|Maze")
+	FVector Extent = FVector::ZeroVector;
+
+	// Yaw of 90 when the box is longer along Y
+	UPROPERTY(BlueprintReadOnly, Category = "Procedural|Maze")
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	// Number of 1x1 walls covered along X and Y
+	UPROPERTY(BlueprintReadOnly, Category = "Procedural|Maze")
+	FIntPoint Size = FIntPoint(1, 1);
+};
 
 /**
  *
@@ -19,13 +81,50 @@ class GAMEKIT_API UGKMazeGeneration : public UBlueprintFunctionLibrary
 	GENERATED_BODY()
 
 public:
+	// All generators draw from a single FRandomStream initialized with Seed
+	// the same seed produces the same maze on every platform
+
 	//! Builds a maze with walls randomly distributed over the grid.
 	//! Returns a list of 1x1 walls that needs to be instantiated.
 	UFUNCTION(BlueprintPure, Category = "Procedural|Maze")
-	static void RandomWall(int GridX, int GridY, float Density, TArray<FIntVector>& Walls);
+	static void RandomWall(int GridX, int GridY, float Density, TArray<FIntVector>& Walls, int Seed = 0);
 
 	//! Builds a maze using DepthFirstSearch
 	//! Returns a list of 1x1 walls that needs to be instantiated.
 	UFUNCTION(BlueprintPure, Category = "Procedural|Maze")
-	static void RandomizedDepthFirstSearch(int GridX, int GridY, TArray<FIntVector>& Walls);
+	static void RandomizedDepthFirstSearch(int GridX, int GridY, TArray<FIntVector>& Walls, int Seed = 0);
+
+	//! Builds a maze using Wilson's algorithm, all the possible mazes are equally likely
+	//! Coverage stops the generation once that percentage of the cells are carved
+	//! MaxSteps bounds the total length of the random walks (0 is unbounded)
+	//! Returns a list of 1x1 walls that needs to be instantiated.
+	UFUNCTION(BlueprintPure, Category = "Procedural|Maze")
+	static void RandomizedWilson(int GridX, int GridY, TArray<FIntVector>& Walls, int Seed = 0, int Coverage = 100, int MaxSteps = 0);
+
+	//! Merge contiguous 1x1 walls returned by the generators into as few boxes as possible
+	//! GridX and GridY are the values given to the generator
+	UFUNCTION(BlueprintPure, Category = "Procedural|Maze")
+	static void MergeWalls(int GridX, int GridY, TArray<FIntVector> const& Walls, TArray<FGKMazeWallBox>& Boxes);
+
+	//! One transform per box, scaling a mesh the size of a 1x1 wall
+	UFUNCTION(BlueprintPure, Category = "Procedural|Maze")
+	static void WallBoxTransforms(TArray<FGKMazeWallBox> const& Boxes, TArray<FTransform>& Transforms);
+
+	//! Add one instance per box, scaling a mesh the size of a 1x1 wall
+	UFUNCTION(BlueprintCallable, Category = "Procedural|Maze")
+	static void AddWallInstances(class UInstancedStaticMeshComponent* Instances, TArray<FGKMazeWallBox> const& Boxes);
+
+	//! Greedily merge the closed cells of Grid into maximal rectangles
+	//! Cell (0, 0) of the grid is at Origin * Spacing
+	static void MergeWallGrid(FGKMazeGrid const& Grid, FIntPoint Origin, FIntPoint Spacing, TArray<FGKMazeWallBox>& Boxes);
+
+	//! Carve a maze inside Grid (which should be closed) using a randomized depth first search
+	//! Grid and Stack can be reused between calls to avoid allocations
+	//! Start is the index of the first cell, it is drawn from the stream when not set
+	static void DepthFirstSearch(FGKMazeGrid& Grid, FRandomStream& Stream, TArray<int32>& Stack, int32 Start = INDEX_NONE);
+
+	//! Carve a maze inside Grid (which should be closed) using loop erased random walks
+	//! Walk stores one direction per cell and can be reused between calls
+	//! Returns false if MaxSteps was reached before the maze was complete
+	static bool Wilson(FGKMazeGrid& Grid, FRandomStream& Stream, TArray<uint8>& Walk, int32 Coverage = 100, int32 MaxSteps = 0);
 };
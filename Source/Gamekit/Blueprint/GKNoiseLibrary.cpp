@@ -0,0 +1,352 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#include "Blueprint/GKNoiseLibrary.h"
+
+#include "Async/ParallelFor.h"
+
+// SampleGrid needs to match Sample bit for bit, the vectorized path is never fused
+// so forbid the compiler from fusing the scalar multiply and add (FMA targets, e.g. ARM64)
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace {
+
+// Rows sampled by a single task, the scratch buffers are shared by the rows of a task
+constexpr int32 RowsPerTask = 8;
+
+// Every function below follows the order of operations of the shader,
+// reordering them would change the rounding
+
+FORCEINLINE float ValueInterpolate(float A, float B, float C, float D, float Fx, float Fy) {
+	float Ux = Fx * Fx * (3.f - 2.f * Fx);
+	float Uy = Fy * Fy * (3.f - 2.f * Fy);
+
+	return A * (1.f - Ux) + B * Ux + (C - A) * Uy * (1.f - Ux) + (D - B) * Ux * Uy;
+}
+
+FORCEINLINE float PerlinInterpolate(float A0, float A1, float W) {
+	if (0.f > W) {
+		return A0;
+	}
+	if (1.f < W) {
+		return A1;
+	}
+	return (A1 - A0) * (3.f - W * 2.f) * W * W + A0;
+}
+
+FORCEINLINE FVector2D RandomGradient(int32 IX, int32 IY) {
+	float Random = 2920.f * FMath::Sin(IX * 21942.f + IY * 171324.f + 8912.f) * FMath::Cos(IX * 23157.f * IY * 217832.f + 9758.f);
+	return FVector2D(FMath::Cos(Random), FMath::Sin(Random));
+}
+
+FORCEINLINE float DotGridGradient(FVector2D Gradient, float Dx, float Dy) { return Dx * Gradient.X + Dy * Gradient.Y; }
+
+FORCEINLINE VectorRegister VectorValueInterpolate(VectorRegister A, VectorRegister B, VectorRegister C, VectorRegister D, VectorRegister Fx, VectorRegister Fy) {
+	VectorRegister const Two   = VectorSetFloat1(2.f);
+	VectorRegister const Three = VectorSetFloat1(3.f);
+	VectorRegister const One   = VectorOne();
+
+	VectorRegister Ux         = VectorMultiply(VectorMultiply(Fx, Fx), VectorSubtract(Three, VectorMultiply(Two, Fx)));
+	VectorRegister Uy         = VectorMultiply(VectorMultiply(Fy, Fy), VectorSubtract(Three, VectorMultiply(Two, Fy)));
+	VectorRegister OneMinusUx = VectorSubtract(One, Ux);
+
+	VectorRegister Value = VectorAdd(VectorMultiply(A, OneMinusUx), VectorMultiply(B, Ux));
+	Value                = VectorAdd(Value, VectorMultiply(VectorMultiply(VectorSubtract(C, A), Uy), OneMinusUx));
+	return VectorAdd(Value, VectorMultiply(VectorMultiply(VectorSubtract(D, B), Ux), Uy));
+}
+
+FORCEINLINE VectorRegister VectorPerlinInterpolate(VectorRegister A0, VectorRegister A1, VectorRegister W) {
+	VectorRegister const Two   = VectorSetFloat1(2.f);
+	VectorRegister const Three = VectorSetFloat1(3.f);
+
+	VectorRegister Value = VectorMultiply(VectorSubtract(A1, A0), VectorSubtract(Three, VectorMultiply(W, Two)));
+	Value                = VectorAdd(VectorMultiply(VectorMultiply(Value, W), W), A0);
+
+	Value = VectorSelect(VectorCompareGT(VectorZero(), W), A0, Value);
+	return VectorSelect(VectorCompareGT(W, VectorOne()), A1, Value);
+}
+
+// Per task buffers, one entry per point of the row
+struct FNoiseRow
+{
+	void Init(int32 Num) {
+		Positions.SetNumUninitialized(Num);
+		for (TArray<float>& Lane: Lanes) {
+			Lane.SetNumUninitialized(Num);
+		}
+	}
+
+	TArray<FVector2D> Positions;
+	TArray<float>     Lanes[12];
+};
+
+// Value noise of one octave, Out = Out + Amplitude * noise(Positions)
+void ValueOctave(FNoiseRow& Row, float* Out, int32 Num, float Amplitude) {
+	float* Fx = Row.Lanes[0].GetData();
+	float* Fy = Row.Lanes[1].GetData();
+	float* A  = Row.Lanes[2].GetData();
+	float* B  = Row.Lanes[3].GetData();
+	float* C  = Row.Lanes[4].GetData();
+	float* D  = Row.Lanes[5].GetData();
+
+	// Lattice values, consecutive points usually share a cell or are in the next one
+	float CellX  = 0.f;
+	float CellY  = 0.f;
+	bool  bValid = false;
+	float Corners[4];
+
+	for (int32 X = 0; X < Num; X++) {
+		FVector2D St = Row.Positions[X];
+		float     IX = FMath::FloorToFloat(St.X);
+		float     IY = FMath::FloorToFloat(St.Y);
+
+		Fx[X] = St.X - IX;
+		Fy[X] = St.Y - IY;
+
+		if (!bValid || IX != CellX || IY != CellY) {
+			if (bValid && IY == CellY && IX == CellX + 1.f) {
+				Corners[0] = Corners[1];
+				Corners[2] = Corners[3];
+			} else {
+				Corners[0] = FGKNoise::Random(FVector2D(IX, IY));
+				Corners[2] = FGKNoise::Random(FVector2D(IX, IY + 1.f));
+			}
+			Corners[1] = FGKNoise::Random(FVector2D(IX + 1.f, IY));
+			Corners[3] = FGKNoise::Random(FVector2D(IX + 1.f, IY + 1.f));
+
+			CellX  = IX;
+			CellY  = IY;
+			bValid = true;
+		}
+
+		A[X] = Corners[0];
+		B[X] = Corners[1];
+		C[X] = Corners[2];
+		D[X] = Corners[3];
+	}
+
+	VectorRegister const VAmplitude = VectorSetFloat1(Amplitude);
+
+	int32 X = 0;
+	for (; X + 4 <= Num; X += 4) {
+		VectorRegister Value = VectorValueInterpolate(VectorLoad(A + X), VectorLoad(B + X), VectorLoad(C + X), VectorLoad(D + X), VectorLoad(Fx + X), VectorLoad(Fy + X));
+		VectorStore(VectorAdd(VectorLoad(Out + X), VectorMultiply(VAmplitude, Value)), Out + X);
+	}
+
+	for (; X < Num; X++) {
+		Out[X] = Out[X] + Amplitude * ValueInterpolate(A[X], B[X], C[X], D[X], Fx[X], Fy[X]);
+	}
+}
+
+void PerlinRow(FNoiseRow& Row, float* Out, int32 Num) {
+	float* Dx0 = Row.Lanes[0].GetData();
+	float* Dx1 = Row.Lanes[1].GetData();
+	float* Dy0 = Row.Lanes[2].GetData();
+	float* Dy1 = Row.Lanes[3].GetData();
+
+	// Gradient of the 4 corners, (x0, y0), (x1, y0), (x0, y1), (x1, y1)
+	float* Gx[4] = {Row.Lanes[4].GetData(), Row.Lanes[5].GetData(), Row.Lanes[6].GetData(), Row.Lanes[7].GetData()};
+	float* Gy[4] = {Row.Lanes[8].GetData(), Row.Lanes[9].GetData(), Row.Lanes[10].GetData(), Row.Lanes[11].GetData()};
+
+	int32     CellX  = 0;
+	int32     CellY  = 0;
+	bool      bValid = false;
+	FVector2D Corners[4];
+
+	for (int32 X = 0; X < Num; X++) {
+		FVector2D St = Row.Positions[X];
+		int32     X0 = (int32)St.X;
+		int32     Y0 = (int32)St.Y;
+
+		Dx0[X] = St.X - (float)X0;
+		Dx1[X] = St.X - (float)(X0 + 1);
+		Dy0[X] = St.Y - (float)Y0;
+		Dy1[X] = St.Y - (float)(Y0 + 1);
+
+		if (!bValid || X0 != CellX || Y0 != CellY) {
+			if (bValid && Y0 == CellY && X0 == CellX + 1) {
+				Corners[0] = Corners[1];
+				Corners[2] = Corners[3];
+			} else {
+				Corners[0] = RandomGradient(X0, Y0);
+				Corners[2] = RandomGradient(X0, Y0 + 1);
+			}
+			Corners[1] = RandomGradient(X0 + 1, Y0);
+			Corners[3] = RandomGradient(X0 + 1, Y0 + 1);
+
+			CellX  = X0;
+			CellY  = Y0;
+			bValid = true;
+		}
+
+		for (int32 i = 0; i < 4; i++) {
+			Gx[i][X] = Corners[i].X;
+			Gy[i][X] = Corners[i].Y;
+		}
+	}
+
+	auto VectorDot = [](VectorRegister Dx, VectorRegister Dy, float const* GX, float const* GY) {
+		return VectorAdd(VectorMultiply(Dx, VectorLoad(GX)), VectorMultiply(Dy, VectorLoad(GY)));
+	};
+
+	int32 X = 0;
+	for (; X + 4 <= Num; X += 4) {
+		VectorRegister VDx0 = VectorLoad(Dx0 + X);
+		VectorRegister VDx1 = VectorLoad(Dx1 + X);
+		VectorRegister VDy0 = VectorLoad(Dy0 + X);
+		VectorRegister VDy1 = VectorLoad(Dy1 + X);
+
+		VectorRegister Ix0 = VectorPerlinInterpolate(VectorDot(VDx0, VDy0, Gx[0] + X, Gy[0] + X), VectorDot(VDx1, VDy0, Gx[1] + X, Gy[1] + X), VDx0);
+		VectorRegister Ix1 = VectorPerlinInterpolate(VectorDot(VDx0, VDy1, Gx[2] + X, Gy[2] + X), VectorDot(VDx1, VDy1, Gx[3] + X, Gy[3] + X), VDx0);
+
+		VectorStore(VectorPerlinInterpolate(Ix0, Ix1, VDy0), Out + X);
+	}
+
+	for (; X < Num; X++) {
+		float Ix0 = PerlinInterpolate(DotGridGradient(FVector2D(Gx[0][X], Gy[0][X]), Dx0[X], Dy0[X]), DotGridGradient(FVector2D(Gx[1][X], Gy[1][X]), Dx1[X], Dy0[X]), Dx0[X]);
+		float Ix1 = PerlinInterpolate(DotGridGradient(FVector2D(Gx[2][X], Gy[2][X]), Dx0[X], Dy1[X]), DotGridGradient(FVector2D(Gx[3][X], Gy[3][X]), Dx1[X], Dy1[X]), Dx0[X]);
+
+		Out[X] = PerlinInterpolate(Ix0, Ix1, Dy0[X]);
+	}
+}
+
+void SampleRow(EGK_NoiseType Type, FNoiseRow& Row, float* Out, int32 Num, int32 Octaves) {
+	if (Type == EGK_NoiseType::Perlin) {
+		return PerlinRow(Row, Out, Num);
+	}
+
+	FMemory::Memzero(Out, Num * sizeof(float));
+
+	if (Type == EGK_NoiseType::Value) {
+		return ValueOctave(Row, Out, Num, 1.f);
+	}
+
+	float const Cos = FMath::Cos(0.5f);
+	float const Sin = FMath::Sin(0.5f);
+
+	float Amplitude = .5f;
+	for (int32 Octave = 0; Octave < Octaves; Octave++) {
+		ValueOctave(Row, Out, Num, Amplitude);
+
+		for (FVector2D& St: Row.Positions) {
+			if (Type == EGK_NoiseType::FBMCloud) {
+				St = FVector2D(Cos * St.X + Sin * St.Y, -Sin * St.X + Cos * St.Y) * 2.f + FVector2D(100.f, 100.f);
+			} else {
+				St = St * 2.f;
+			}
+		}
+		Amplitude *= .5f;
+	}
+}
+
+} // namespace
+
+float FGKNoise::Random(FVector2D St) {
+	return FMath::Frac(FMath::Sin(St.X * 12.9898f + St.Y * 78.233f) * 43758.5453123f);
+}
+
+float FGKNoise::Value(FVector2D St) {
+	FVector2D I(FMath::FloorToFloat(St.X), FMath::FloorToFloat(St.Y));
+
+	// Four corners in 2D of a tile
+	float A = Random(I);
+	float B = Random(FVector2D(I.X + 1.f, I.Y));
+	float C = Random(FVector2D(I.X, I.Y + 1.f));
+	float D = Random(FVector2D(I.X + 1.f, I.Y + 1.f));
+
+	return ValueInterpolate(A, B, C, D, St.X - I.X, St.Y - I.Y);
+}
+
+float FGKNoise::FBM(FVector2D St, int32 Octaves) {
+	float Result    = 0.f;
+	float Amplitude = .5f;
+
+	for (int32 i = 0; i < Octaves; i++) {
+		Result += Amplitude * Value(St);
+		St        = St * 2.f;
+		Amplitude *= .5f;
+	}
+	return Result;
+}
+
+float FGKNoise::FBMCloud(FVector2D St, int32 Octaves) {
+	float Result    = 0.f;
+	float Amplitude = .5f;
+
+	// Rotate to reduce axial bias
+	float const Cos = FMath::Cos(0.5f);
+	float const Sin = FMath::Sin(0.5f);
+
+	for (int32 i = 0; i < Octaves; i++) {
+		Result += Amplitude * Value(St);
+		St        = FVector2D(Cos * St.X + Sin * St.Y, -Sin * St.X + Cos * St.Y) * 2.f + FVector2D(100.f, 100.f);
+		Amplitude *= .5f;
+	}
+	return Result;
+}
+
+float FGKNoise::Perlin(float X, float Y) {
+	// Truncated like the shader, not floored
+	int32 X0 = (int32)X;
+	int32 X1 = X0 + 1;
+	int32 Y0 = (int32)Y;
+	int32 Y1 = Y0 + 1;
+
+	float Sx = X - (float)X0;
+	float Sy = Y - (float)Y0;
+
+	float N0  = DotGridGradient(RandomGradient(X0, Y0), X - (float)X0, Y - (float)Y0);
+	float N1  = DotGridGradient(RandomGradient(X1, Y0), X - (float)X1, Y - (float)Y0);
+	float Ix0 = PerlinInterpolate(N0, N1, Sx);
+
+	N0        = DotGridGradient(RandomGradient(X0, Y1), X - (float)X0, Y - (float)Y1);
+	N1        = DotGridGradient(RandomGradient(X1, Y1), X - (float)X1, Y - (float)Y1);
+	float Ix1 = PerlinInterpolate(N0, N1, Sx);
+
+	return PerlinInterpolate(Ix0, Ix1, Sy);
+}
+
+float FGKNoise::Sample(EGK_NoiseType Type, FVector2D St, int32 Octaves) {
+	switch (Type) {
+	case EGK_NoiseType::Value:
+		return Value(St);
+	case EGK_NoiseType::FBM:
+		return FBM(St, Octaves);
+	case EGK_NoiseType::FBMCloud:
+		return FBMCloud(St, Octaves);
+	case EGK_NoiseType::Perlin:
+		return Perlin(St.X, St.Y);
+	}
+	return 0.f;
+}
+
+void FGKNoise::SampleGrid(EGK_NoiseType Type, FVector2D Origin, FVector2D Step, FIntPoint Size, int32 Octaves, TArray<float>& Out) {
+	Out.Reset();
+
+	if (Size.X <= 0 || Size.Y <= 0) {
+		return;
+	}
+
+	Out.SetNumUninitialized(Size.X * Size.Y);
+	float* Data = Out.GetData();
+
+	ParallelFor(FMath::DivideAndRoundUp(Size.Y, RowsPerTask), [&](int32 Task) {
+		FNoiseRow Row;
+		Row.Init(Size.X);
+
+		int32 End = FMath::Min((Task + 1) * RowsPerTask, Size.Y);
+
+		for (int32 Y = Task * RowsPerTask; Y < End; Y++) {
+			for (int32 X = 0; X < Size.X; X++) {
+				Row.Positions[X] = GridPosition(Origin, Step, X, Y);
+			}
+
+			SampleRow(Type, Row, Data + Y * Size.X, Size.X, Octaves);
+		}
+	});
+}
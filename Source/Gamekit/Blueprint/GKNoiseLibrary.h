@@ -0,0 +1,88 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+
+#include "GKNoiseLibrary.generated.h"
+
+UENUM(BlueprintType)
+enum class EGK_NoiseType : uint8
+{
+	Value    UMETA(DisplayName = "Value"),    // noise
+	FBM      UMETA(DisplayName = "FBM"),      // fbm
+	FBMCloud UMETA(DisplayName = "FBMCloud"), // fbm_cloud
+	Perlin   UMETA(DisplayName = "Perlin"),   // perlin
+};
+
+/** CPU implementation of Shaders/noise.usf and Shaders/perlin.usf
+ *
+ * The functions follow the shader code operation by operation in single precision
+ * so gameplay code and the server can sample the same noise as the materials.
+ * sin and cos come from the platform math library, GPUs use their own
+ * approximation so the last bits can differ from the shader.
+ *
+ * SampleGrid returns exactly the same values as calling Sample on each point,
+ * floating point contraction is disabled in GKNoiseLibrary.cpp to guarantee it.
+ */
+struct GAMEKIT_API FGKNoise
+{
+	//! random
+	static float Random(FVector2D St);
+
+	//! noise, value noise interpolated between the random values of the integer lattice
+	static float Value(FVector2D St);
+
+	//! fbm
+	static float FBM(FVector2D St, int32 Octaves);
+
+	//! fbm_cloud
+	static float FBMCloud(FVector2D St, int32 Octaves);
+
+	//! perlin
+	static float Perlin(float X, float Y);
+
+	//! Octaves is ignored by Value and Perlin
+	static float Sample(EGK_NoiseType Type, FVector2D St, int32 Octaves);
+
+	//! Position of the point (X, Y) of a grid
+	static FVector2D GridPosition(FVector2D Origin, FVector2D Step, int32 X, int32 Y) {
+		return FVector2D(Origin.X + Step.X * float(X), Origin.Y + Step.Y * float(Y));
+	}
+
+	//! Sample a Size.X x Size.Y grid, Out[Y * Size.X + X] is the value at GridPosition(Origin, Step, X, Y)
+	//! Rows are split between worker threads and interpolated 4 points at a time
+	static void SampleGrid(EGK_NoiseType Type, FVector2D Origin, FVector2D Step, FIntPoint Size, int32 Octaves, TArray<float>& Out);
+};
+
+/**
+ * Should match the shader equivalent
+ */
+UCLASS()
+class GAMEKIT_API UGKNoiseLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintPure, Category = "Procedural|Noise")
+	static float RandomNoise(FVector2D St) { return FGKNoise::Random(St); }
+
+	UFUNCTION(BlueprintPure, Category = "Procedural|Noise")
+	static float ValueNoise(FVector2D St) { return FGKNoise::Value(St); }
+
+	UFUNCTION(BlueprintPure, Category = "Procedural|Noise")
+	static float FBMNoise(FVector2D St, int Octaves = 6) { return FGKNoise::FBM(St, Octaves); }
+
+	UFUNCTION(BlueprintPure, Category = "Procedural|Noise")
+	static float FBMCloudNoise(FVector2D St, int Octaves = 6) { return FGKNoise::FBMCloud(St, Octaves); }
+
+	UFUNCTION(BlueprintPure, Category = "Procedural|Noise")
+	static float PerlinNoise(FVector2D St) { return FGKNoise::Perlin(St.X, St.Y); }
+
+	//! Sample a grid of noise, Out[Y * Size.X + X] is the value at Origin + Step * (X, Y)
+	UFUNCTION(BlueprintCallable, Category = "Procedural|Noise")
+	static void SampleNoiseGrid(EGK_NoiseType Type, FVector2D Origin, FVector2D Step, FIntPoint Size, int Octaves, TArray<float>& Out) {
+		FGKNoise::SampleGrid(Type, Origin, Step, Size, Octaves, Out);
+	}
+};
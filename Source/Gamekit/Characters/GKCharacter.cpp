@@ -6,6 +6,8 @@
 #include "Abilities/GKGameplayAbility.h"
 #include "Abilities/GKAbilityStatic.h"
 #include "Items/GKItem.h"
+#include "Projectiles/GKAOEManager.h"
+#include "Utilities/GKDataTableRegistry.h"
 
 #include "AbilitySystemGlobals.h"
 #include "GameFramework/CharacterMovementComponent.h"
@@ -22,11 +24,14 @@ AGKCharacterBase::AGKCharacterBase()
 
 	CharacterLevel = 1;
 	InputsBound = false;
+	UnitStatic = nullptr;
+	UnitStaticRevision = 0;
 }
 
 void AGKCharacterBase::OnDataTableChanged_Native() {
 	// Reset Cache
 	UnitStatic = nullptr;
+	UnitStaticRevision = 0;
 	GetUnitStatic();
 }
 
@@ -125,8 +130,10 @@ void AGKCharacterBase::K2_GetUnitStatic(FGKUnitStatic& UnitStaticOut, bool& Vali
 }
 
 FGKUnitStatic* AGKCharacterBase::GetUnitStatic() {
+	FGKDataTableRegistry& Registry = FGKDataTableRegistry::Get();
+
 	// We have already a cached lookup
-	if (UnitStatic) {
+	if (UnitStatic && UnitStaticRevision == Registry.GetRevision()) {
 		return UnitStatic;
 	}
 
@@ -135,18 +142,15 @@ FGKUnitStatic* AGKCharacterBase::GetUnitStatic() {
 		return nullptr;
 	}
 
-	UnitStatic = UnitDataTable->FindRow<FGKUnitStatic>(UnitRowName, TEXT("Unit"), true);
-		
-	if (UnitStatic != nullptr){
-		LoadFromDataTable(*UnitStatic);
-	}
-	else {
-		UE_LOG(LogGamekit, Warning, TEXT("Did not find  Unit static"));
-	}
+	// The row is shared by every unit, reload only if it is new or its table changed
+	FGKUnitStatic* Row = Registry.FindRow<FGKUnitStatic>(UnitDataTable, UnitRowName, TEXT("Unit"));
+	bool bReload = Row != UnitStatic || Registry.GetTableRevision(UnitDataTable) > UnitStaticRevision;
+
+	UnitStatic = Row;
+	UnitStaticRevision = Registry.GetRevision();
 
-	// Listen to data table change
-	if (!UnitDataTable->OnDataTableChanged().IsBoundToObject(this)) {
-		UnitDataTable->OnDataTableChanged().AddUObject(this, &AGKCharacterBase::OnDataTableChanged_Native);
+	if (UnitStatic != nullptr && bReload) {
+		LoadFromDataTable(*UnitStatic);
 	}
 
 	return UnitStatic;
@@ -161,18 +165,31 @@ UAbilitySystemComponent* AGKCharacterBase::GetAbilitySystemComponent() const
 void AGKCharacterBase::BeginPlay() {
 	Super::BeginPlay();
 
+	// Area of effects are resolved on the server
+	if (HasAuthority()) {
+		GetWorld()->GetSubsystem<UGKAOEManagerSubsystem>()->RegisterUnit(this);
+	}
+
 	// Initialize our abilities
 	if (AbilitySystemComponent)
 	{
 		AbilitySystemComponent->InitAbilityActorInfo(this, this);
 
 		if (UnitDataTable && UnitRowName.IsValid()) {
-			UE_LOG(LogGamekit, Warning, TEXT("Loading Unit Config From DataTable"));
+			UE_LOG(LogGamekit, Verbose, TEXT("Loading Unit Config From DataTable"));
 			OnDataTableChanged_Native();
 		}
 	}
 }
 
+void AGKCharacterBase::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (UGKAOEManagerSubsystem* AOEManager = GetWorld()->GetSubsystem<UGKAOEManagerSubsystem>()) {
+		AOEManager->UnregisterUnit(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AGKCharacterBase::PossessedBy(AController* NewController)
 {
 	Super::PossessedBy(NewController);
@@ -286,7 +303,7 @@ bool AGKCharacterBase::ActivateAbility(FGKAbilitySlot Slot) {
 		return false;
 	}
 
-	return AbilitySystemComponent->TryActivateAbility(Spec->Handle, true);
+	return AbilitySystemComponent->TryActivateAbilityQueued(Spec->Handle);
 }
 
 int AGKCharacterBase::AbilityCount() const {
@@ -50,6 +50,8 @@ public:
 
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void PossessedBy(AController* NewController) override;
 
 	virtual void UnPossessed() override;
@@ -107,7 +109,7 @@ public:
 	//! Client side register the granted ability
 	void OnGiveAbility_Native(FGameplayAbilitySpec& AbilitySpec);
 
-	//! Low level ability activation
+	//! Low level ability activation, queued if another ability is casting
 	UFUNCTION(BlueprintCallable, Category = Abilities)
 	bool ActivateAbility(FGKAbilitySlot Slot);
 
@@ -136,6 +138,7 @@ public:
 
 	FGKUnitStatic* GetUnitStatic();
 
+	//! Drop the cached lookup and load the row again
 	UFUNCTION()
 	void OnDataTableChanged_Native();
 
@@ -146,6 +149,9 @@ public:
 	//! Cached lookup
 	FGKUnitStatic* UnitStatic;
 
+	//! FGKDataTableRegistry revision UnitStatic was resolved at
+	uint32 UnitStaticRevision;
+
 	void PostInitProperties() override;
 
 protected:
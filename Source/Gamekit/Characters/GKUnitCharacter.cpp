@@ -8,6 +8,7 @@
 #include "Controllers/GKUnitController.h"
 #include "Grid/GKMovementUtility.h"
 #include "Characters/GKTopDownPawn.h"
+#include "Grid/GKHexGrid.h"
 
 #include "Blueprint/AIBlueprintHelperLibrary.h"
 #include "Blueprint/BlueprintExtension.h"
@@ -17,6 +18,7 @@
 #include "Camera/CameraComponent.h"
 #include "Components/WidgetComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "EngineUtils.h"
 
 
 // Sets default values
@@ -42,11 +44,26 @@ AGKUnitCharacter::AGKUnitCharacter()
 	// The root Component is only defined here
 	// we need to set it to get correct world location
 	StatusDisplay->SetupAttachment(GetCapsuleComponent());
+
+	MovementPoints = 5;
 }
 
 // Called when the game starts or when spawned
 void AGKUnitCharacter::BeginPlay(){
 	Super::BeginPlay();
+
+	// Stand on our tile so other units path around us
+	for (TActorIterator<AGKHexGrid> It(GetWorld()); It; ++It){
+		It->PlaceUnit(this);
+	}
+}
+
+void AGKUnitCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason){
+	for (TActorIterator<AGKHexGrid> It(GetWorld()); It; ++It){
+		It->ReleaseUnitTiles(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 
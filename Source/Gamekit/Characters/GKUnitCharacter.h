@@ -25,6 +25,8 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void Tick(float DeltaTime) override;
 
 public:
@@ -34,4 +36,8 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Attributes, meta = (AllowPrivateAccess = "true"))
 	class UWidgetComponent* StatusDisplay;
 
+	// Movement points the unit can spend in a turn on a hex grid
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+	int MovementPoints;
+
 };
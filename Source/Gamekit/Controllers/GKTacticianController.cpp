@@ -12,6 +12,7 @@
 #include "Runtime/Engine/Classes/Components/DecalComponent.h"
 #include "HeadMountedDisplayFunctionLibrary.h"
 #include "Engine/World.h"
+#include "EngineUtils.h"
 #include "GameFramework/SpringArmComponent.h"
 
 
@@ -21,6 +22,20 @@ AGKTacticianController::AGKTacticianController()
 	DefaultMouseCursor = EMouseCursor::Crosshairs;
 }
 
+void AGKTacticianController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (Grid == nullptr){
+		TActorIterator<AGKHexGrid> It(GetWorld());
+		Grid = It ? *It : nullptr;
+	}
+
+	if (Grid == nullptr){
+		UE_LOG(LogTemp, Warning, TEXT("No hex grid found, units will move freely"));
+	}
+}
+
 void AGKTacticianController::PlayerTick(float DeltaTime)
 {
 	Super::PlayerTick(DeltaTime);
@@ -55,6 +70,21 @@ void AGKTacticianController::OnSelect(){
             */
 		}
 
+		// Claim the destination tile so other units do not path into it
+		if (Grid != nullptr){
+			auto origin = Grid->GetActorLocation();
+			auto from   = UGKHexGridUtilities::WorldToGrid(Grid->GetTileSize(), SelectedUnit->GetActorLocation() - origin);
+			auto to     = UGKHexGridUtilities::WorldToGrid(Grid->GetTileSize(), Hit.ImpactPoint - origin);
+
+			if (Grid->ContainsTile(to)){
+				if (!Grid->MoveReservation(from, to, SelectedUnit)){
+					UE_LOG(LogTemp, Warning, TEXT("Tile is occupied, Abort move"));
+					return;
+				}
+				worldPos = UGKHexGridUtilities::GridToWorld(Grid->GetTileSize(), to) + origin;
+			}
+		}
+
 		UE_LOG(LogTemp, Warning, TEXT("Moving unit to %f x %f"), worldPos.X, worldPos.Y);
 		SelectedUnit->MoveUnit(worldPos);
 	}
@@ -72,9 +102,22 @@ void AGKTacticianController::SetSelectedUnit(AGKUnitCharacter* unit){
 	if (unit != nullptr){
 		UE_LOG(LogTemp, Warning, TEXT("Selected unit"));
 		SelectedUnit = unit;
+
+		// Movement range is ready for highlighting when the selection event fires
+		if (Grid != nullptr){
+			// The unit might have spawned before the grid had its tiles
+			if (!Grid->PlaceUnit(unit)){
+				UE_LOG(LogTemp, Warning, TEXT("Selected unit is not standing on a free tile"));
+			}
+
+			auto gridPos = UGKHexGridUtilities::WorldToGrid(Grid->GetTileSize(), unit->GetActorLocation() - Grid->GetActorLocation());
+			Grid->GetReachableTiles(gridPos, unit->MovementPoints, ReachableTiles, unit);
+		}
+
 		OnUnitSelection();
 	} else if (SelectedUnit != nullptr) {
 		SelectedUnit = unit;
+		ReachableTiles.Reset();
 		UE_LOG(LogTemp, Warning, TEXT("Unselect unit"));
 		OnUnitUnselect();
 	}
@@ -8,6 +8,7 @@
 #include "CoreMinimal.h"
 
 #include "GameFramework/PlayerController.h"
+#include "Grid/GKHexGrid.h"
 
 #include "GKTacticianController.generated.h"
 
@@ -20,6 +21,8 @@ public:
 	AGKTacticianController();
 
 protected:
+	virtual void BeginPlay() override;
+
 	// Begin PlayerController interface
 	virtual void PlayerTick(float DeltaTime) override;
 	virtual void SetupInputComponent() override;
@@ -41,6 +44,14 @@ protected:
 	UFUNCTION(BlueprintCallable)
 	class AGKUnitCharacter* GetSelectedUnit();
 
+	// Grid the selected units move on, found in the level on BeginPlay if not set
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadWrite, Category = "Selection")
+	class AGKHexGrid* Grid;
+
+	// Tiles the selected unit can reach, updated before OnUnitSelection is called
+	UPROPERTY(BlueprintReadOnly, Category = "Selection")
+	FGKHexReachableTiles ReachableTiles;
+
 	UFUNCTION(BlueprintNativeEvent, Category = "Selection")
 	void OnUnitSelection();
 
@@ -7,8 +7,17 @@
 
 #include "UObject/ConstructorHelpers.h"
 #include "Grid/GKHexGridUtilities.h"
+#include "Grid/GKHexVisibility.h"
+#include "Gamekit.h"
 
+#include "Algo/Reverse.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/Texture2D.h"
 #include "Materials/Material.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/SoftObjectPath.h"
 #include "Engine/StaticMesh.h"
 
 // Sets default values
@@ -17,6 +26,8 @@ AGKHexGrid::AGKHexGrid()
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
 	static ConstructorHelpers::FObjectFinder<UMaterial> DefaultHexMaterial(TEXT("Material'/Gamekit/Tiles/TilePlaceholderMat.TilePlaceholderMat'"));
 	static ConstructorHelpers::FObjectFinder<UMaterial> DefaultHexMaterialAlt(TEXT("Material'/Gamekit/Tiles/TilePlaceholderMat2.TilePlaceholderMat2'"));
 
@@ -32,54 +43,244 @@ AGKHexGrid::AGKHexGrid()
 	if (TileMeshRef.Succeeded()){
 		SetTileMesh(TileMeshRef.Object);
 	}
+
+	HierarchicalThreshold = GKHEX_CHUNK_SIZE * 2;
+	PathCacheSize         = 256;
+	NextOccupantId        = GKHEX_NO_OCCUPANT + 1;
 }
 
 
-void AGKHexGrid::LoadCircleMap(int radius){
-	for(auto i = 0; i < radius; i++){
-		for(auto j = 0; j < radius; j++){
-			auto points = {
-				FIntPoint( i,  j),
-				FIntPoint(-i,  j),
-				FIntPoint( i, -j),
-				FIntPoint(-i, -j)
-			};
-
-			for (auto p: points){
-				int MatIdx = 0;
-				auto cube = UGKHexGridUtilities::AxialToCube(FVector2D(p.X, p.Y));
-				if (cube.X == 0 || cube.Y == 0 || cube.Z == 0){
-					MatIdx = 1;
-				}
-
-				if (UGKHexGridUtilities::Distance(FIntPoint(0, 0), p) <= radius * TileSize.X){
-					AddTile(FIntVector(p.X, p.Y, 0), MatIdx);
-				}
+namespace {
+
+void GenerateMask(FGKHexMapShape const& Shape, TArray<FIntPoint>& Tiles) {
+	UTexture2D* Mask = Shape.Mask;
+
+	if (Mask == nullptr || Mask->PlatformData == nullptr || Mask->PlatformData->Mips.Num() == 0){
+		UE_LOG(LogGamekit, Warning, TEXT("Hex map mask is not set"));
+		return;
+	}
+
+	if (Mask->GetPixelFormat() != PF_B8G8R8A8){
+		UE_LOG(LogGamekit, Warning, TEXT("Hex map mask %s needs to be uncompressed (BGRA8)"), *Mask->GetName());
+		return;
+	}
+
+	FTexture2DMipMap& Mip       = Mask->PlatformData->Mips[0];
+	FColor const*     Pixels    = static_cast<FColor const*>(Mip.BulkData.LockReadOnly());
+	uint8             Threshold = uint8(FMath::Clamp(Shape.MaskThreshold, 0.f, 1.f) * 255.f);
+
+	if (Pixels == nullptr){
+		Mip.BulkData.Unlock();
+		return;
+	}
+
+	Tiles.Reserve(Mip.SizeX * Mip.SizeY);
+	for (int32 Y = 0; Y < Mip.SizeY; Y++){
+		for (int32 X = 0; X < Mip.SizeX; X++){
+			if (Pixels[Y * Mip.SizeX + X].R < Threshold){
+				continue;
 			}
+
+			// Odd rows are shifted, convert offset coordinates to axial
+			int32 Row = Y - Mip.SizeY / 2;
+			int32 Col = X - Mip.SizeX / 2;
+			Tiles.Emplace(Col - (Row - (Row & 1)) / 2, Row);
 		}
 	}
+
+	Mip.BulkData.Unlock();
 }
 
-void AGKHexGrid::LoadRectangleMap(int radius){
-	for(auto i = 0; i < radius; i++){
-		for(auto j = 0; j < radius; j++){
-			auto points = {
-				FIntPoint( i,  j),
-				FIntPoint(-i,  j),
-				FIntPoint( i, -j),
-				FIntPoint(-i, -j)
-			};
-
-			for (auto p: points){
-				int MatIdx = 0;
-				auto cube = UGKHexGridUtilities::AxialToCube(FVector2D(p.X, p.Y));
-				if (cube.X == 0 || cube.Y == 0 || cube.Z == 0){
-					MatIdx = 1;
-				}
-
-				AddTile(FIntVector(p.X, p.Y, 0), MatIdx);
+void GenerateShape(FGKHexMapShape const& Shape, TArray<FIntPoint>& Tiles) {
+	int32 Radius = FMath::Max(Shape.Radius, 0);
+
+	switch (Shape.Shape){
+	case EGKHexMapShape::Hexagon:
+		Tiles.Reserve(FGKHexSpiralIterator::Num(Radius));
+		for (FGKHexRangeIterator It(FIntPoint(0, 0), Radius); It; ++It){
+			Tiles.Add(*It);
+		}
+		return;
+
+	case EGKHexMapShape::Rectangle:
+		Tiles.Reserve(Shape.Size.X * Shape.Size.Y);
+		for (int32 Y = 0; Y < Shape.Size.Y; Y++){
+			for (int32 X = 0; X < Shape.Size.X; X++){
+				int32 Row = Y - Shape.Size.Y / 2;
+				int32 Col = X - Shape.Size.X / 2;
+				Tiles.Emplace(Col - (Row - (Row & 1)) / 2, Row);
+			}
+		}
+		return;
+
+	case EGKHexMapShape::Parallelogram:
+		Tiles.Reserve(FMath::Square(FMath::Max(2 * Radius - 1, 0)));
+		for (int32 R = -Radius + 1; R < Radius; R++){
+			for (int32 Q = -Radius + 1; Q < Radius; Q++){
+				Tiles.Emplace(Q, R);
+			}
+		}
+		return;
+
+	case EGKHexMapShape::Circle:
+		Tiles.Reserve(FGKHexSpiralIterator::Num(Radius));
+		for (FGKHexRangeIterator It(FIntPoint(0, 0), Radius); It; ++It){
+			// Distance between tile centers in tile units
+			FIntPoint Tile = *It;
+			float     X    = float(Tile.X) + float(Tile.Y) * 0.5f;
+			float     Y    = float(Tile.Y) * 0.866025404f;
+
+			if (X * X + Y * Y <= float(Radius * Radius)){
+				Tiles.Add(Tile);
 			}
 		}
+		return;
+
+	case EGKHexMapShape::Mask:
+		GenerateMask(Shape, Tiles);
+		return;
+	}
+}
+
+}
+
+void AGKHexGrid::LoadCircleMap(int radius){
+	// The distance check of the original loader compared tiles to world units
+	// and never rejected a tile, the map it produced was a parallelogram
+	LoadRectangleMap(radius);
+}
+
+void AGKHexGrid::LoadRectangleMap(int radius){
+	FGKHexMapShape Shape;
+	Shape.Shape  = EGKHexMapShape::Parallelogram;
+	Shape.Radius = radius;
+	BuildMap(Shape, false);
+}
+
+void AGKHexGrid::BuildMap(FGKHexMapShape const& Shape, bool bClear){
+	if (bClear){
+		ClearMap();
+	}
+
+	TArray<FIntPoint> Tiles;
+	GenerateShape(Shape, Tiles);
+
+	if (Tiles.Num() == 0){
+		return;
+	}
+
+	// Create all the chunks up front
+	FIntPoint Min = Tiles[0];
+	FIntPoint Max = Tiles[0];
+	for (FIntPoint const& Tile: Tiles){
+		Min = FIntPoint(FMath::Min(Min.X, Tile.X), FMath::Min(Min.Y, Tile.Y));
+		Max = FIntPoint(FMath::Max(Max.X, Tile.X), FMath::Max(Max.Y, Tile.Y));
+	}
+	Storage.ReserveArea(Min, Max);
+
+	int32 Material     = TileMaterials.IsValidIndex(Shape.Material) ? Shape.Material : 0;
+	int32 AxisMaterial = TileMaterials.IsValidIndex(Shape.AxisMaterial) ? Shape.AxisMaterial : Material;
+
+	TArray<int32> Added;
+	Added.Reserve(Tiles.Num());
+
+	for (FIntPoint const& Tile: Tiles){
+		FGKHexTileData Data;
+		bool           bAxis = Tile.X == 0 || Tile.Y == 0 || Tile.X + Tile.Y == 0;
+		Data.Material = bAxis ? AxisMaterial : Material;
+
+		int32 Index = Storage.Add(Tile, Data);
+		if (Index != INDEX_NONE){
+			Added.Add(Index);
+		}
+	}
+
+	CommitTileVisuals(Added);
+	Hierarchy.MarkAllDirty();
+}
+
+void AGKHexGrid::ClearMap(){
+	for (UInstancedStaticMeshComponent* Instances: TileInstances){
+		if (Instances != nullptr){
+			Instances->ClearInstances();
+		}
+	}
+
+	TileInstanceIndices.Reset();
+	Storage.Reset();
+	Occupancy.Reset();
+	OccupantIds.Reset();
+	Hierarchy.MarkAllDirty();
+}
+
+UInstancedStaticMeshComponent* AGKHexGrid::GetTileInstances(int MatIdx){
+	if (TileInstances.Num() <= MatIdx){
+		TileInstances.SetNumZeroed(MatIdx + 1);
+	}
+
+	UInstancedStaticMeshComponent*& Instances = TileInstances[MatIdx];
+	if (Instances == nullptr){
+		Instances = NewObject<UInstancedStaticMeshComponent>(this);
+		Instances->SetupAttachment(GetRootComponent());
+		Instances->SetStaticMesh(TileMesh);
+
+		if (TileMaterials.IsValidIndex(MatIdx)){
+			Instances->SetMaterial(0, TileMaterials[MatIdx]);
+		}
+		Instances->RegisterComponent();
+	}
+	return Instances;
+}
+
+void AGKHexGrid::CommitTileVisuals(TArrayView<const int32> Indices){
+	if (TileMesh == nullptr){
+		UE_LOG(LogTemp, Warning, TEXT("Tile Mesh was not set!"));
+		return;
+	}
+
+	TArray<FIntVector> Grid;
+	TArray<FVector>    World;
+	Grid.SetNumUninitialized(Indices.Num());
+	World.SetNumUninitialized(Indices.Num());
+
+	for (int32 i = 0; i < Indices.Num(); i++){
+		Grid[i] = IndexToGrid(Indices[i]);
+	}
+	UGKHexGridUtilities::GridToWorldBatch(FGKHexGridConstants(GetTileSize()), Grid, World);
+
+	TArray<TArray<FTransform>, TInlineAllocator<4>> Transforms;
+	TArray<TArray<int32>, TInlineAllocator<4>>      Tiles;
+	Transforms.SetNum(FMath::Max(TileMaterials.Num(), 1));
+	Tiles.SetNum(Transforms.Num());
+
+	for (int32 i = 0; i < Indices.Num(); i++){
+		FGKHexTileData& Tile = Storage.At(Indices[i]);
+
+		if (!Transforms.IsValidIndex(Tile.Material)){
+			Tile.Material = 0;
+		}
+		Transforms[Tile.Material].Emplace(World[i]);
+		Tiles[Tile.Material].Add(Indices[i]);
+	}
+
+	// Storage grew, new slots have no instance
+	for (int32 Index = TileInstanceIndices.Num(); Index < Storage.GetIndexCount(); Index++){
+		TileInstanceIndices.Add(INDEX_NONE);
+	}
+
+	for (int32 MatIdx = 0; MatIdx < Transforms.Num(); MatIdx++){
+		if (Transforms[MatIdx].Num() == 0){
+			continue;
+		}
+
+		// Instances are appended
+		UInstancedStaticMeshComponent* Instances = GetTileInstances(MatIdx);
+		int32                          First     = Instances->GetInstanceCount();
+		Instances->AddInstances(Transforms[MatIdx], false);
+
+		for (int32 i = 0; i < Tiles[MatIdx].Num(); i++){
+			TileInstanceIndices[Tiles[MatIdx][i]] = First + i;
+		}
 	}
 }
 
@@ -91,45 +292,452 @@ void AGKHexGrid::AddTileFromWorld(FVector w, int MatIdx) {
 int AGKHexGrid::AddMaterial(class UMaterial* m){
 	int size = TileMaterials.Num();
 
-	if (m != nullptr){
-		TileMaterials.Add(m);
-	} else {
+	if (m == nullptr){
+		return -1;
+	}
+
+	// Tiles store their material index on 8 bits
+	if (size > MAX_uint8){
+		UE_LOG(LogGamekit, Warning, TEXT("Too many tile materials (max: %d)"), MAX_uint8 + 1);
 		return -1;
 	}
 
+	TileMaterials.Add(m);
+
 	return size;
 }
 
 void AGKHexGrid::AddTile(FIntVector w, int MatIdx) {
-	if (GridMap.Contains(w)){
+	if (ContainsTile(w)){
 		UE_LOG(LogTemp, Warning, TEXT("TileID: (%d x %d x %d) already there"), w.X, w.Y, w.Z);
 		return;
 	}
 
-	if (MatIdx < 0 || MatIdx >= TileMaterials.Num()){
+	if (MatIdx < 0 || MatIdx >= TileMaterials.Num() || MatIdx > MAX_uint8){
 		UE_LOG(LogTemp, Warning, TEXT("(MaterialID: %d) out of bound"), MatIdx);
 		return;
 	}
 
+	// Elevation is stored on 16 bits
+	if (w.Z < MIN_int16 || w.Z > MAX_int16){
+		UE_LOG(LogGamekit, Warning, TEXT("TileID: (%d x %d x %d) elevation out of bound, clamped"), w.X, w.Y, w.Z);
+		w.Z = FMath::Clamp(w.Z, int32(MIN_int16), int32(MAX_int16));
+	}
+
 	if (TileMesh == nullptr){
 		UE_LOG(LogTemp, Warning, TEXT("Tile Mesh was not set!"));
 		return;
 	}
 
-	auto mesh = NewObject<UStaticMeshComponent>();
-	mesh->SetupAttachment(GetRootComponent());
-	mesh->SetStaticMesh(TileMesh);
-	mesh->SetMaterial(0, TileMaterials[MatIdx]);
-	mesh->SetRelativeLocation(UGKHexGridUtilities::GridToWorld(GetTileSize(), w));
-	GridMap.Add(w, mesh);
+	FGKHexTileData Data;
+	Data.Material  = uint8(MatIdx);
+	Data.Elevation = int16(w.Z);
+
+	int32 Index = Storage.Add(FIntPoint(w.X, w.Y), Data);
+	if (Index != INDEX_NONE){
+		CommitTileVisuals(MakeArrayView(&Index, 1));
+		OnTileChanged(FIntPoint(w.X, w.Y));
+	}
+}
+
+bool AGKHexGrid::SerializeMap(FArchive& Ar) {
+	uint32 Magic   = GKHEX_MAP_MAGIC;
+	int32  Version = GKHEX_MAP_VERSION;
+
+	Ar << Magic;
+	Ar << Version;
+
+	if (Ar.IsLoading() && (Magic != GKHEX_MAP_MAGIC || Version <= 0 || Version > GKHEX_MAP_VERSION)){
+		UE_LOG(LogGamekit, Warning, TEXT("Unsupported hex map (magic: %x, version: %d)"), Magic, Version);
+		return false;
+	}
+
+	// Material palette
+	TArray<FSoftObjectPath> Palette;
+	if (Ar.IsSaving()){
+		for (UMaterial* Material: TileMaterials){
+			Palette.Add(FSoftObjectPath(Material));
+		}
+	}
+	Ar << Palette;
+
+	if (!Ar.IsLoading()){
+		Storage.Serialize(Ar);
+		return !Ar.IsError();
+	}
+
+	// Keep the current map if the file is invalid
+	FGKHexGridStorage Loaded;
+	Loaded.Serialize(Ar);
+
+	if (Ar.IsError()){
+		UE_LOG(LogGamekit, Warning, TEXT("Hex map is truncated or corrupted"));
+		return false;
+	}
+
+	ClearMap();
+	Storage.Replace(MoveTemp(Loaded));
+
+	// Map the saved palette to our materials
+	TArray<uint8, TInlineAllocator<16>> Remap;
+	for (FSoftObjectPath const& Path: Palette){
+		UMaterial* Material = Cast<UMaterial>(Path.TryLoad());
+		int32      MatIdx   = TileMaterials.Find(Material);
+
+		if (MatIdx == INDEX_NONE){
+			MatIdx = FMath::Max(AddMaterial(Material), 0);
+		}
+		Remap.Add(uint8(MatIdx));
+	}
+
+	TArray<int32> Indices;
+	Indices.Reserve(Storage.Num());
+
+	for (int32 Index = 0; Index < Storage.GetIndexCount(); Index++){
+		FGKHexTileData& Tile = Storage.At(Index);
+
+		if (Tile.IsPresent()){
+			Tile.Material = Remap.IsValidIndex(Tile.Material) ? Remap[Tile.Material] : 0;
+			Indices.Add(Index);
+		}
+	}
+
+	CommitTileVisuals(Indices);
+	Hierarchy.MarkAllDirty();
+	return true;
+}
+
+bool AGKHexGrid::SaveMapToFile(FString const& Filename) {
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data, true);
+
+	if (!SerializeMap(Writer)){
+		return false;
+	}
+	return FFileHelper::SaveArrayToFile(Data, *Filename);
+}
+
+bool AGKHexGrid::LoadMapFromFile(FString const& Filename) {
+	TArray<uint8> Data;
+
+	if (!FFileHelper::LoadFileToArray(Data, *Filename)){
+		UE_LOG(LogGamekit, Warning, TEXT("Could not read hex map %s"), *Filename);
+		return false;
+	}
+
+	FMemoryReader Reader(Data, true);
+	return SerializeMap(Reader);
+}
+
+void AGKHexGrid::BakeMap() {
+	Modify();
+	BakedMap.Reset();
+
+	FMemoryWriter Writer(BakedMap, true);
+	SerializeMap(Writer);
 }
 
 bool AGKHexGrid::ContainsTile(FIntVector w) const {
-	return GridMap.Contains(w);
+	return Storage.TileIndexOf(FIntPoint(w.X, w.Y)) != INDEX_NONE;
 }
 
 UStaticMeshComponent* AGKHexGrid::GetTile(FIntVector w) {
-	return GridMap.FindRef(w);
+	UInstancedStaticMeshComponent* Instances     = nullptr;
+	int32                          InstanceIndex = INDEX_NONE;
+
+	GetTileInstance(w, Instances, InstanceIndex);
+	return Instances;
+}
+
+bool AGKHexGrid::GetTileInstance(FIntVector w, UInstancedStaticMeshComponent*& Instances, int32& InstanceIndex) {
+	Instances     = nullptr;
+	InstanceIndex = INDEX_NONE;
+
+	int32 Index = Storage.TileIndexOf(FIntPoint(w.X, w.Y));
+	if (Index == INDEX_NONE || !TileInstanceIndices.IsValidIndex(Index) || TileInstanceIndices[Index] == INDEX_NONE){
+		return false;
+	}
+
+	int32 MatIdx = Storage.At(Index).Material;
+	if (!TileInstances.IsValidIndex(MatIdx)){
+		return false;
+	}
+
+	Instances     = TileInstances[MatIdx];
+	InstanceIndex = TileInstanceIndices[Index];
+	return Instances != nullptr;
+}
+
+void AGKHexGrid::OnTileChanged(FIntPoint Axial) {
+	Storage.BumpRevision();
+	Hierarchy.MarkDirty(Storage, FGKHexGridStorage::ChunkOf(Axial));
+}
+
+void AGKHexGrid::SetTileCost(FIntVector w, int Cost) {
+	int32 Index = Storage.TileIndexOf(FIntPoint(w.X, w.Y));
+	if (Index == INDEX_NONE){
+		return;
+	}
+
+	Storage.At(Index).Cost = FMath::Clamp(Cost, 1, 255);
+	OnTileChanged(FIntPoint(w.X, w.Y));
+}
+
+void AGKHexGrid::SetTileBlocking(FIntVector w, bool bBlocking) {
+	int32 Index = Storage.TileIndexOf(FIntPoint(w.X, w.Y));
+	if (Index == INDEX_NONE){
+		return;
+	}
+
+	FGKHexTileData& Tile = Storage.At(Index);
+	if (bBlocking){
+		Tile.Flags |= GKHex_Blocking;
+	} else {
+		Tile.Flags &= ~GKHex_Blocking;
+	}
+	OnTileChanged(FIntPoint(w.X, w.Y));
+}
+
+void AGKHexGrid::SetTileBlocksSight(FIntVector w, bool bBlocksSight) {
+	int32 Index = Storage.TileIndexOf(FIntPoint(w.X, w.Y));
+	if (Index == INDEX_NONE){
+		return;
+	}
+
+	FGKHexTileData& Tile = Storage.At(Index);
+	if (bBlocksSight){
+		Tile.Flags |= GKHex_BlocksSight;
+	} else {
+		Tile.Flags &= ~GKHex_BlocksSight;
+	}
+	Storage.BumpRevision();
+}
+
+bool AGKHexGrid::HasLineOfSight(FIntVector A, FIntVector B) const {
+	return FGKHexVisibility::HasLineOfSight(Storage, FIntPoint(A.X, A.Y), FIntPoint(B.X, B.Y));
+}
+
+void AGKHexGrid::ComputeFieldOfView(FIntVector Center, int Radius, TBitArray<>& Visible) const {
+	FGKHexVisibility::ComputeFieldOfView(Storage, FIntPoint(Center.X, Center.Y), Radius, Visible);
+}
+
+void AGKHexGrid::GetVisibleTiles(FIntVector Center, int Radius, TArray<FIntVector>& Tiles) const {
+	TBitArray<> Visible;
+	ComputeFieldOfView(Center, Radius, Visible);
+
+	Tiles.Reset();
+	for (TConstSetBitIterator<> It(Visible); It; ++It){
+		Tiles.Add(IndexToGrid(It.GetIndex()));
+	}
+}
+
+FIntVector AGKHexGrid::IndexToGrid(int32 Index) const {
+	FIntPoint Axial = Storage.AxialOf(Index);
+	return FIntVector(Axial.X, Axial.Y, Storage.At(Index).Elevation);
+}
+
+int32 AGKHexGrid::GetOccupantId(AActor const* Unit) const {
+	if (Unit == nullptr){
+		return GKHEX_NO_OCCUPANT;
+	}
+
+	// Units that never reserved a tile still avoid the others
+	int32 const* Id = OccupantIds.Find(FObjectKey(Unit));
+	return Id != nullptr ? *Id : INDEX_NONE;
+}
+
+int32 AGKHexGrid::FindOrAddOccupantId(AActor const* Unit) {
+	if (Unit == nullptr){
+		return GKHEX_NO_OCCUPANT;
+	}
+
+	int32& Id = OccupantIds.FindOrAdd(FObjectKey(Unit), GKHEX_NO_OCCUPANT);
+	if (Id == GKHEX_NO_OCCUPANT){
+		Id = NextOccupantId++;
+	}
+	return Id;
+}
+
+bool AGKHexGrid::ReserveTile(FIntVector Tile, AActor* Unit) {
+	int32 Index = Storage.TileIndexOf(FIntPoint(Tile.X, Tile.Y));
+	if (Index == INDEX_NONE || !Storage.At(Index).IsWalkable()){
+		return false;
+	}
+
+	Occupancy.Sync(Storage.GetIndexCount());
+	return Occupancy.Reserve(Index, FindOrAddOccupantId(Unit));
+}
+
+bool AGKHexGrid::ReleaseTile(FIntVector Tile, AActor* Unit) {
+	return Occupancy.Release(Storage.TileIndexOf(FIntPoint(Tile.X, Tile.Y)), GetOccupantId(Unit));
+}
+
+bool AGKHexGrid::MoveReservation(FIntVector From, FIntVector To, AActor* Unit) {
+	int32 Index = Storage.TileIndexOf(FIntPoint(To.X, To.Y));
+	if (Index == INDEX_NONE || !Storage.At(Index).IsWalkable()){
+		return false;
+	}
+
+	Occupancy.Sync(Storage.GetIndexCount());
+	return Occupancy.Move(Storage.TileIndexOf(FIntPoint(From.X, From.Y)), Index, FindOrAddOccupantId(Unit));
+}
+
+void AGKHexGrid::ReleaseUnitTiles(AActor* Unit) {
+	int32 Owner = GetOccupantId(Unit);
+	if (Owner == GKHEX_NO_OCCUPANT || Owner == INDEX_NONE){
+		return;
+	}
+
+	Occupancy.ReleaseAll(Owner);
+	OccupantIds.Remove(FObjectKey(Unit));
+}
+
+bool AGKHexGrid::PlaceUnit(AActor* Unit) {
+	if (Unit == nullptr){
+		return false;
+	}
+
+	// Already placed, the unit might be walking to the tile it reserved
+	if (GetOccupantId(Unit) != INDEX_NONE){
+		return true;
+	}
+
+	FIntVector Tile = UGKHexGridUtilities::WorldToGrid(GetTileSize(), Unit->GetActorLocation() - GetActorLocation());
+	return ReserveTile(Tile, Unit);
+}
+
+bool AGKHexGrid::IsTileOccupied(FIntVector Tile, AActor* Ignore) const {
+	int32 Index = Storage.TileIndexOf(FIntPoint(Tile.X, Tile.Y));
+	return !Occupancy.IsFree(Index, GetOccupantId(Ignore));
+}
+
+bool AGKHexGrid::SearchPath(int32 Start, int32 Goal, TArray<int32>& Path, int32 Owner) {
+	FGKHexOccupancy const* Units = Owner != GKHEX_NO_OCCUPANT ? &Occupancy : nullptr;
+
+	int32 Distance = FGKHexPathfinder::Distance(Storage.AxialOf(Start), Storage.AxialOf(Goal));
+	if (Distance > HierarchicalThreshold){
+		// Units can block the paths of the abstract graph, fallback to a full search
+		// whenever the abstract graph finds nothing so no existing path is missed
+		if (Hierarchy.FindPath(Storage, Scratch, Start, Goal, Path, Units, Owner)){
+			return true;
+		}
+	}
+	return FGKHexPathfinder::FindPath(Storage, Scratch, Start, Goal, Path, INDEX_NONE, Units, Owner);
+}
+
+bool AGKHexGrid::FindPathIndices(int32 Start, int32 Goal, TArray<int32>& Path, int32 Owner) {
+	if (Start == INDEX_NONE || Goal == INDEX_NONE){
+		Path.Reset();
+		return false;
+	}
+
+	if (PathCache.GetCapacity() != PathCacheSize){
+		PathCache.SetCapacity(PathCacheSize);
+	}
+
+	if (PathCache.GetCapacity() == 0){
+		return SearchPath(Start, Goal, Path, Owner);
+	}
+
+	// Occupancy only matters when searching for a unit
+	uint64 Revision = Storage.GetRevision();
+	if (Owner != GKHEX_NO_OCCUPANT){
+		Revision |= uint64(uint32(Occupancy.GetRevision())) << 32;
+	}
+
+	FGKHexPathKey Key{Start, Goal, Owner};
+	if (FGKHexCachedPath const* Cached = PathCache.Find(Key, Revision)){
+		Path = Cached->Path;
+		return Cached->bFound;
+	}
+
+	bool bFound = SearchPath(Start, Goal, Path, Owner);
+	PathCache.Add(Key, Revision, Path, bFound);
+	return bFound;
+}
+
+FGKHexPathCacheStats AGKHexGrid::GetPathCacheStats() const {
+	FGKHexPathCacheStats Stats;
+	Stats.Hits      = PathCache.GetHits();
+	Stats.Misses    = PathCache.GetMisses();
+	Stats.Evictions = PathCache.GetEvictions();
+	Stats.Size      = PathCache.Num();
+
+	int32 Lookups = Stats.Hits + Stats.Misses;
+	Stats.HitRate = Lookups > 0 ? float(Stats.Hits) / float(Lookups) : 0.f;
+	return Stats;
+}
+
+bool AGKHexGrid::FindPath(FIntVector Start, FIntVector Goal, TArray<FIntVector>& Path, AActor* Unit) {
+	TArray<int32> Indices;
+	Path.Reset();
+
+	bool bFound = FindPathIndices(
+		Storage.TileIndexOf(FIntPoint(Start.X, Start.Y)),
+		Storage.TileIndexOf(FIntPoint(Goal.X, Goal.Y)),
+		Indices,
+		GetOccupantId(Unit)
+	);
+
+	Path.Reserve(Indices.Num());
+	for (int32 Index: Indices){
+		Path.Add(IndexToGrid(Index));
+	}
+	return bFound;
+}
+
+void AGKHexGrid::GetReachableTiles(FIntVector Start, int Budget, FGKHexReachableTiles& Result, AActor* Unit) {
+	int32 Owner = GetOccupantId(Unit);
+
+	auto TileCost = [this, Owner](int32 From, int32 To) -> int32 {
+		FGKHexTileData const& Tile = Storage.At(To);
+		if (!Tile.IsWalkable() || (Owner != GKHEX_NO_OCCUPANT && !Occupancy.IsFree(To, Owner))){
+			return -1;
+		}
+		return Tile.Cost;
+	};
+
+	GetReachableTilesWithCost(Start, Budget, TileCost, Result);
+}
+
+void AGKHexGrid::GetReachableTilesWithCost(FIntVector Start, int Budget, FGKHexCostFunction CostFn, FGKHexReachableTiles& Result) {
+	FGKHexPathfinder::Reachable(Storage, Scratch, Storage.TileIndexOf(FIntPoint(Start.X, Start.Y)), Budget, CostFn, ReachableIndices);
+
+	Result.Reset(ReachableIndices.Num());
+
+	for (int32 Index: ReachableIndices){
+		int32 Parent = Scratch.Parent[Index];
+
+		FIntVector Tile = IndexToGrid(Index);
+		Result.Lookup.Add(Tile, Result.Tiles.Add(Tile));
+		Result.Predecessors.Add(Parent != INDEX_NONE ? Scratch.Order[Parent] : INDEX_NONE);
+		Result.Costs.Add(Scratch.Cost[Index]);
+	}
+}
+
+bool AGKHexGrid::GetPathToReachableTile(FGKHexReachableTiles const& Reachable, FIntVector Tile, TArray<FIntVector>& Path) {
+	Path.Reset();
+
+	// Results built by hand from blueprint do not have the lookup
+	int32 Index = INDEX_NONE;
+	if (Reachable.Lookup.Num() == Reachable.Tiles.Num()){
+		int32 const* Found = Reachable.Lookup.Find(Tile);
+		Index = Found != nullptr ? *Found : INDEX_NONE;
+	} else {
+		Index = Reachable.Tiles.Find(Tile);
+	}
+
+	if (Index == INDEX_NONE){
+		return false;
+	}
+
+	while (Index != INDEX_NONE){
+		Path.Add(Reachable.Tiles[Index]);
+		Index = Reachable.Predecessors[Index];
+	}
+
+	Algo::Reverse(Path);
+	return true;
 }
 
 void AGKHexGrid::SetTileMesh(class UStaticMesh* m) {
@@ -146,6 +754,11 @@ void AGKHexGrid::BeginPlay()
 {
 	Super::BeginPlay();
 
+	if (BakedMap.Num() > 0 && Storage.Num() == 0){
+		FMemoryReader Reader(BakedMap, true);
+		SerializeMap(Reader);
+	}
+
 }
 
 // Called every frame
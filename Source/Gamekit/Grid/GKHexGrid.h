@@ -6,11 +6,113 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
 
 #include "GameFramework/Actor.h"
 
+#include "Grid/GKHexGridStorage.h"
+#include "Grid/GKHexOccupancy.h"
+#include "Grid/GKHexPathCache.h"
+#include "Grid/GKHexPathfinding.h"
+
 #include "GKHexGrid.generated.h"
 
+// 'GKHX'
+#define GKHEX_MAP_MAGIC   0x58484B47
+#define GKHEX_MAP_VERSION 1
+
+UENUM(BlueprintType)
+enum class EGKHexMapShape : uint8
+{
+	Hexagon,       // Tiles within Radius of the origin
+	Rectangle,     // Size.X x Size.Y tiles in offset coordinates (rows)
+	Parallelogram, // |q| < Radius and |r| < Radius
+	Circle,        // Tiles whose center is within Radius tiles of the origin
+	Mask,          // One tile per texel of Mask above MaskThreshold, laid out as Rectangle
+};
+
+// Describes the tiles generated by AGKHexGrid::BuildMap
+USTRUCT(BlueprintType)
+struct GAMEKIT_API FGKHexMapShape
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = MapLoading)
+	EGKHexMapShape Shape = EGKHexMapShape::Hexagon;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = MapLoading)
+	int Radius = 10;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = MapLoading)
+	FIntPoint Size = FIntPoint(20, 20);
+
+	// Texture needs to be uncompressed (BGRA8) without mips so it is readable on CPU
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = MapLoading)
+	class UTexture2D* Mask = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = MapLoading)
+	float MaskThreshold = 0.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = MapLoading)
+	int Material = 0;
+
+	// Material of the tiles on the axes, -1 to use Material
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = MapLoading)
+	int AxisMaterial = 1;
+};
+
+// Result of a movement range query
+USTRUCT(BlueprintType)
+struct GAMEKIT_API FGKHexReachableTiles
+{
+	GENERATED_BODY()
+
+	// Reachable tiles sorted by cost, the first tile is the start
+	UPROPERTY(BlueprintReadOnly, Category = Pathfinding)
+	TArray<FIntVector> Tiles;
+
+	// Index inside Tiles of the previous tile on the path, -1 for the start
+	UPROPERTY(BlueprintReadOnly, Category = Pathfinding)
+	TArray<int32> Predecessors;
+
+	// Movement points needed to reach the tile
+	UPROPERTY(BlueprintReadOnly, Category = Pathfinding)
+	TArray<int32> Costs;
+
+	// Index inside Tiles of each tile, filled by the search
+	TMap<FIntVector, int32> Lookup;
+
+	void Reset(int32 Num = 0) {
+		Tiles.Reset(Num);
+		Predecessors.Reset(Num);
+		Costs.Reset(Num);
+		Lookup.Reset();
+		Lookup.Reserve(Num);
+	}
+};
+
+// Usage of the path cache, used to size it
+USTRUCT(BlueprintType)
+struct GAMEKIT_API FGKHexPathCacheStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = Pathfinding)
+	int32 Hits = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = Pathfinding)
+	int32 Misses = 0;
+
+	// Valid entries dropped because the cache was full
+	UPROPERTY(BlueprintReadOnly, Category = Pathfinding)
+	int32 Evictions = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = Pathfinding)
+	int32 Size = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = Pathfinding)
+	float HitRate = 0.f;
+};
 
 UCLASS()
 class GAMEKIT_API AGKHexGrid : public AActor
@@ -32,10 +134,6 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Tile, meta = (AllowPrivateAccess = "true"))
 	FVector2D TileSize;
 
-	// Allow us to query the map by coordinate
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Tile, meta = (AllowPrivateAccess = "true"))
-	TMap<FIntVector, class UStaticMeshComponent*> GridMap;
-
 	// Shared Tile Mesh
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Tile, meta = (AllowPrivateAccess = "true"))
 	class UStaticMesh* TileMesh;
@@ -44,6 +142,54 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Tile, meta = (AllowPrivateAccess = "true"))
 	TArray<class UMaterial*> TileMaterials;
 
+	// One instanced mesh per material, used to display tiles created in bulk
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Tile, meta = (AllowPrivateAccess = "true"))
+	TArray<class UInstancedStaticMeshComponent*> TileInstances;
+
+	// Instance of each tile inside the TileInstances of its material, aligned with the storage
+	TArray<int32> TileInstanceIndices;
+
+	// Paths longer than this (in tiles) use the hierarchical path finder
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Pathfinding, meta = (AllowPrivateAccess = "true"))
+	int HierarchicalThreshold;
+
+	// Number of path results kept, 0 disables the cache
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Pathfinding, meta = (AllowPrivateAccess = "true"))
+	int PathCacheSize;
+
+	// Tile data of every tile, used for path finding and bulk tile creation
+	FGKHexGridStorage   Storage;
+	FGKHexHierarchy     Hierarchy;
+	FGKHexSearchScratch Scratch;
+	TArray<int32>       ReachableIndices;
+
+	// Units standing on or moving to each tile
+	FGKHexOccupancy Occupancy;
+
+	// Results of FindPathIndices, invalidated by tile and occupancy changes
+	FGKHexPathCache PathCache;
+
+	// Occupant identifier of each unit, identifiers are never reused
+	TMap<FObjectKey, int32> OccupantIds;
+	int32                   NextOccupantId;
+
+	int32 FindOrAddOccupantId(AActor const* Unit);
+
+	// Run the path search, bypassing the cache
+	bool SearchPath(int32 Start, int32 Goal, TArray<int32>& Path, int32 Owner);
+
+	// Map saved in the level by BakeMap, loaded on BeginPlay
+	UPROPERTY()
+	TArray<uint8> BakedMap;
+
+	// Invalidate data derived from a tile
+	void OnTileChanged(FIntPoint Axial);
+
+	// Display tiles (storage indices) as instances, grouped by material
+	void CommitTileVisuals(TArrayView<const int32> Indices);
+
+	class UInstancedStaticMeshComponent* GetTileInstances(int MatIdx);
+
 public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -66,12 +212,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category = Tile)
 	FVector2D GetTileSize() const { return TileSize + FVector2D(1.f, 1.f) * Margin;}
 
+	// Same as BuildMap with a Parallelogram shape
 	UFUNCTION(BlueprintCallable, Category = MapLoading)
 	void LoadRectangleMap(int radius);
 
+	// Kept for compatibility, generates the same parallelogram as LoadRectangleMap
+	// use BuildMap with a Circle shape for a round map
 	UFUNCTION(BlueprintCallable, Category = MapLoading)
 	void LoadCircleMap(int radius);
 
+	// Generate all the tiles of a shape in one pass and add them as a single batch
+	// Existing tiles are kept unless bClear is set
+	UFUNCTION(BlueprintCallable, Category = MapLoading)
+	void BuildMap(FGKHexMapShape const& Shape, bool bClear = true);
+
+	// Remove all the tiles
+	UFUNCTION(BlueprintCallable, Category = MapLoading)
+	void ClearMap();
+
 	UFUNCTION(BlueprintCallable, Category = MapLoading)
 	void AddTileFromWorld(FVector w, int MatIdx);
 
@@ -79,9 +237,119 @@ public:
 	UFUNCTION(BlueprintCallable, Category = MapLoading)
 	void AddTile(FIntVector w, int Material);
 
+	// Save the tiles in the binary map format
 	UFUNCTION(BlueprintCallable, Category = MapLoading)
-	bool ContainsTile(FIntVector w) const;
+	bool SaveMapToFile(FString const& Filename);
+
+	// Replace the current tiles by the ones saved in the file
+	UFUNCTION(BlueprintCallable, Category = MapLoading)
+	bool LoadMapFromFile(FString const& Filename);
+
+	// Serialize the current tiles inside the level so they are loaded on BeginPlay
+	UFUNCTION(CallInEditor, Category = MapLoading)
+	void BakeMap();
+
+	/** Save or load the map
+	 *
+	 * Format: magic, version, material palette as asset paths, tile chunks.
+	 * Chunks are stored as raw memory so loading does not go through AddTile.
+	 */
+	bool SerializeMap(FArchive& Ar);
 
 	UFUNCTION(BlueprintCallable, Category = MapLoading)
+	bool ContainsTile(FIntVector w) const;
+
+	// Tiles are instances, returns the instanced mesh holding the tile
+	UFUNCTION(BlueprintCallable, Category = MapLoading, meta = (DeprecatedFunction, DeprecationMessage = "Use GetTileInstance"))
 	class UStaticMeshComponent* GetTile(FIntVector w);
+
+	// Returns the instanced mesh and the instance index used to display the tile
+	UFUNCTION(BlueprintCallable, Category = MapLoading)
+	bool GetTileInstance(FIntVector w, class UInstancedStaticMeshComponent*& Instances, int32& InstanceIndex);
+
+	// Cost of entering the tile, between 1 and 255
+	UFUNCTION(BlueprintCallable, Category = Tile)
+	void SetTileCost(FIntVector w, int Cost);
+
+	// Blocking tiles cannot be walked on
+	UFUNCTION(BlueprintCallable, Category = Tile)
+	void SetTileBlocking(FIntVector w, bool bBlocking);
+
+	// Tiles blocking sight hide the tiles behind them
+	UFUNCTION(BlueprintCallable, Category = Tile)
+	void SetTileBlocksSight(FIntVector w, bool bBlocksSight);
+
+	// Returns true if no tile between A and B blocks sight
+	UFUNCTION(BlueprintCallable, Category = Visibility)
+	bool HasLineOfSight(FIntVector A, FIntVector B) const;
+
+	// Returns the tiles visible from Center within Radius
+	UFUNCTION(BlueprintCallable, Category = Visibility)
+	void GetVisibleTiles(FIntVector Center, int Radius, UPARAM(ref) TArray<FIntVector>& Tiles) const;
+
+	// Visible tiles as a bitset aligned with the tile storage
+	void ComputeFieldOfView(FIntVector Center, int Radius, TBitArray<>& Visible) const;
+
+	// Claim a tile for a unit, fails if the tile is not walkable or held by another unit
+	UFUNCTION(BlueprintCallable, Category = Occupancy)
+	bool ReserveTile(FIntVector Tile, AActor* Unit);
+
+	// Free a tile held by the unit
+	UFUNCTION(BlueprintCallable, Category = Occupancy)
+	bool ReleaseTile(FIntVector Tile, AActor* Unit);
+
+	// Reserve the destination then release the origin, nothing changes if the destination is taken
+	UFUNCTION(BlueprintCallable, Category = Occupancy)
+	bool MoveReservation(FIntVector From, FIntVector To, AActor* Unit);
+
+	// Free every tile held by the unit (death, despawn)
+	UFUNCTION(BlueprintCallable, Category = Occupancy)
+	void ReleaseUnitTiles(AActor* Unit);
+
+	// Claim the tile under a unit that does not hold any tile yet, fails if another unit holds it
+	UFUNCTION(BlueprintCallable, Category = Occupancy)
+	bool PlaceUnit(AActor* Unit);
+
+	// Returns true if the tile is held by a unit other than Ignore
+	UFUNCTION(BlueprintCallable, Category = Occupancy)
+	bool IsTileOccupied(FIntVector Tile, AActor* Ignore = nullptr) const;
+
+	// Identifier of a unit inside the occupancy layer
+	// GKHEX_NO_OCCUPANT without unit, INDEX_NONE for units holding no tile
+	int32 GetOccupantId(AActor const* Unit) const;
+
+	// Find the cheapest path between two tiles, the path includes both ends
+	// Long paths are computed on the hierarchical graph and might be slightly longer than optimal,
+	// a full search runs when the hierarchical one fails
+	// When Unit is set, tiles held by other units are avoided
+	UFUNCTION(BlueprintCallable, Category = Pathfinding)
+	bool FindPath(FIntVector Start, FIntVector Goal, TArray<FIntVector>& Path, AActor* Unit = nullptr);
+
+	// Returns all the tiles that can be reached from Start spending at most Budget movement points
+	// Result arrays are reused between calls to avoid allocations
+	// When Unit is set, tiles held by other units cannot be crossed
+	UFUNCTION(BlueprintCallable, Category = Pathfinding)
+	void GetReachableTiles(FIntVector Start, int Budget, FGKHexReachableTiles& Result, AActor* Unit = nullptr);
+
+	// Same as GetReachableTiles using a custom movement cost
+	void GetReachableTilesWithCost(FIntVector Start, int Budget, FGKHexCostFunction CostFn, FGKHexReachableTiles& Result);
+
+	// Build the path to a tile returned by GetReachableTiles without searching again
+	UFUNCTION(BlueprintPure, Category = Pathfinding)
+	static bool GetPathToReachableTile(FGKHexReachableTiles const& Reachable, FIntVector Tile, TArray<FIntVector>& Path);
+
+	UFUNCTION(BlueprintCallable, Category = Pathfinding)
+	FGKHexPathCacheStats GetPathCacheStats() const;
+
+	UFUNCTION(BlueprintCallable, Category = Pathfinding)
+	void ResetPathCacheStats() { PathCache.ResetStats(); }
+
+	// Same as FindPath but working on storage indices, results are cached
+	bool FindPathIndices(int32 Start, int32 Goal, TArray<int32>& Path, int32 Owner = GKHEX_NO_OCCUPANT);
+
+	FIntVector IndexToGrid(int32 Index) const;
+
+	FGKHexGridStorage const& GetStorage() const { return Storage; }
+
+	FGKHexOccupancy const& GetOccupancy() const { return Occupancy; }
 };
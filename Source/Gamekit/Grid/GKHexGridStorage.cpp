@@ -0,0 +1,166 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#include "Grid/GKHexGridStorage.h"
+
+#include "Serialization/Archive.h"
+
+const FIntPoint FGKHexGridStorage::Directions[6] = {
+	FIntPoint(+1,  0), FIntPoint(+1, -1), FIntPoint( 0, -1),
+	FIntPoint(-1,  0), FIntPoint(-1, +1), FIntPoint( 0, +1),
+};
+
+FGKHexTileData const* FGKHexGridStorage::Find(FIntPoint Axial) const {
+	int32 Index = TileIndexOf(Axial);
+	if (Index == INDEX_NONE) {
+		return nullptr;
+	}
+	return &At(Index);
+}
+
+int32 FGKHexGridStorage::FindOrAddChunk(FIntPoint ChunkCoord) {
+	if (int32* Slot = ChunkLookup.Find(ChunkCoord)) {
+		return *Slot;
+	}
+
+	int32 Slot = Chunks.AddDefaulted();
+	Chunks[Slot].Coord = ChunkCoord;
+	ChunkLookup.Add(ChunkCoord, Slot);
+	return Slot;
+}
+
+int32 FGKHexGridStorage::Add(FIntPoint Axial, FGKHexTileData const& Tile) {
+	int32           Slot  = FindOrAddChunk(ChunkOf(Axial));
+	int32           Local = LocalOf(Axial);
+	FGKHexTileData& Data  = Chunks[Slot].Tiles[Local];
+
+	if (Data.IsPresent()) {
+		return INDEX_NONE;
+	}
+
+	Data = Tile;
+	Data.Flags |= GKHex_Present;
+	Chunks[Slot].Count += 1;
+	TileCount += 1;
+	BumpRevision();
+	return Slot * GKHEX_CHUNK_AREA + Local;
+}
+
+bool FGKHexGridStorage::Remove(FIntPoint Axial) {
+	int32 Index = TileIndexOf(Axial);
+	if (Index == INDEX_NONE) {
+		return false;
+	}
+
+	At(Index) = FGKHexTileData();
+	Chunks[Index / GKHEX_CHUNK_AREA].Count -= 1;
+	TileCount -= 1;
+	BumpRevision();
+	return true;
+}
+
+void FGKHexGridStorage::Reset() {
+	Chunks.Reset();
+	ChunkLookup.Reset();
+	TileCount = 0;
+	BumpRevision();
+}
+
+void FGKHexGridStorage::Replace(FGKHexGridStorage&& Other) {
+	uint32 Previous = FMath::Max(Revision, Other.Revision);
+
+	Chunks      = MoveTemp(Other.Chunks);
+	ChunkLookup = MoveTemp(Other.ChunkLookup);
+	TileCount   = Other.TileCount;
+	Revision    = Previous + 1;
+
+	Other.Reset();
+}
+
+void FGKHexGridStorage::ReserveArea(FIntPoint Min, FIntPoint Max) {
+	FIntPoint MinChunk = ChunkOf(Min);
+	FIntPoint MaxChunk = ChunkOf(Max);
+	int32     Count    = (MaxChunk.X - MinChunk.X + 1) * (MaxChunk.Y - MinChunk.Y + 1);
+
+	Chunks.Reserve(Chunks.Num() + Count);
+	ChunkLookup.Reserve(ChunkLookup.Num() + Count);
+
+	for (int32 Y = MinChunk.Y; Y <= MaxChunk.Y; Y++) {
+		for (int32 X = MinChunk.X; X <= MaxChunk.X; X++) {
+			FindOrAddChunk(FIntPoint(X, Y));
+		}
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FGKHexTileData& Tile) {
+	Ar << Tile.Flags;
+	Ar << Tile.Material;
+	Ar << Tile.Cost;
+	Ar << Tile.Padding;
+	Ar << Tile.Elevation;
+	return Ar;
+}
+
+void FGKHexGridStorage::Serialize(FArchive& Ar) {
+	int32 ChunkCount = Chunks.Num();
+	Ar << ChunkCount;
+
+	if (Ar.IsLoading()) {
+		Reset();
+
+		int64 Remaining = Ar.TotalSize() - Ar.Tell();
+
+		if (ChunkCount < 0 || (Ar.TotalSize() >= 0 && Remaining < int64(ChunkCount) * int64(sizeof(FGKHexChunk)))) {
+			Ar.SetError();
+			return;
+		}
+		Chunks.SetNumUninitialized(ChunkCount);
+	}
+
+	if (!Ar.IsByteSwapping()) {
+		Ar.Serialize(Chunks.GetData(), int64(ChunkCount) * sizeof(FGKHexChunk));
+	} else {
+		for (FGKHexChunk& Chunk: Chunks) {
+			Ar << Chunk.Coord;
+			Ar << Chunk.Count;
+
+			for (FGKHexTileData& Tile: Chunk.Tiles) {
+				Ar << Tile;
+			}
+		}
+	}
+
+	if (!Ar.IsLoading()) {
+		return;
+	}
+
+	// Axial coordinates of every tile need to fit in an int32
+	const int32 MaxCoord = MAX_int32 >> (GKHEX_CHUNK_BITS + 1);
+
+	ChunkLookup.Reserve(ChunkCount);
+
+	for (int32 Slot = 0; Slot < ChunkCount && !Ar.IsError(); Slot++) {
+		FGKHexChunk const& Chunk = Chunks[Slot];
+
+		int32 Present = 0;
+		for (FGKHexTileData const& Tile: Chunk.Tiles) {
+			Present += Tile.IsPresent() ? 1 : 0;
+		}
+
+		bool bInvalid = FMath::Abs(Chunk.Coord.X) > MaxCoord || FMath::Abs(Chunk.Coord.Y) > MaxCoord;
+		bInvalid |= Chunk.Count != Present || ChunkLookup.Contains(Chunk.Coord);
+
+		if (bInvalid) {
+			Ar.SetError();
+			break;
+		}
+
+		ChunkLookup.Add(Chunk.Coord, Slot);
+		TileCount += Chunk.Count;
+	}
+
+	if (Ar.IsError()) {
+		Reset();
+		return;
+	}
+	BumpRevision();
+}
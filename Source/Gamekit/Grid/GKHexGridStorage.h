@@ -0,0 +1,169 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Chunks are GKHEX_CHUNK_SIZE x GKHEX_CHUNK_SIZE tiles in axial coordinates
+#define GKHEX_CHUNK_BITS 4
+#define GKHEX_CHUNK_SIZE (1 << GKHEX_CHUNK_BITS)
+#define GKHEX_CHUNK_MASK (GKHEX_CHUNK_SIZE - 1)
+#define GKHEX_CHUNK_AREA (GKHEX_CHUNK_SIZE * GKHEX_CHUNK_SIZE)
+
+enum EGKHexTileFlags : uint8
+{
+	GKHex_None        = 0,
+	GKHex_Present     = 1 << 0, // Tile exists
+	GKHex_Blocking    = 1 << 1, // Tile cannot be walked on
+	GKHex_BlocksSight = 1 << 2, // Tile cannot be seen through
+};
+
+//! Compact per tile data, the visual (mesh component) lives on the grid actor
+struct FGKHexTileData
+{
+	uint8 Flags     = GKHex_None;
+	uint8 Material  = 0;
+	uint8 Cost      = 1; // Cost of entering the tile
+	uint8 Padding   = 0;
+	int16 Elevation = 0;
+
+	bool IsPresent () const { return (Flags & GKHex_Present) != 0; }
+	bool IsBlocking() const { return (Flags & GKHex_Blocking) != 0; }
+
+	//! Tile exists and can be walked on
+	bool IsWalkable() const { return (Flags & (GKHex_Present | GKHex_Blocking)) == GKHex_Present; }
+};
+
+struct FGKHexChunk
+{
+	FIntPoint      Coord;
+	int32          Count = 0;
+	FGKHexTileData Tiles[GKHEX_CHUNK_AREA];
+};
+
+// Chunks are saved as raw memory, the layout is part of the map format
+static_assert(sizeof(FGKHexTileData) == 6, "FGKHexTileData layout changed, bump GKHEX_MAP_VERSION");
+static_assert(sizeof(FGKHexChunk) == 12 + 6 * GKHEX_CHUNK_AREA, "FGKHexChunk layout changed, bump GKHEX_MAP_VERSION");
+
+FArchive& operator<<(FArchive& Ar, FGKHexTileData& Tile);
+
+/** Sparse chunked storage of hex tiles keyed by axial coordinates
+ *
+ * Every tile slot gets a stable dense index (ChunkSlot * GKHEX_CHUNK_AREA + Local)
+ * that can be used to align scratch buffers, bitsets or per tile layers
+ * with the storage without going through a hash map.
+ * Chunks are never freed so indices remain valid until Reset().
+ */
+class GAMEKIT_API FGKHexGridStorage
+{
+public:
+	//! Chunk coordinate of an axial coordinate (floor division)
+	static FIntPoint ChunkOf(FIntPoint Axial) {
+		return FIntPoint(Axial.X >> GKHEX_CHUNK_BITS, Axial.Y >> GKHEX_CHUNK_BITS);
+	}
+
+	//! Index of the tile inside its chunk
+	static int32 LocalOf(FIntPoint Axial) {
+		return (Axial.X & GKHEX_CHUNK_MASK) | ((Axial.Y & GKHEX_CHUNK_MASK) << GKHEX_CHUNK_BITS);
+	}
+
+	//! Dense index of a tile slot, INDEX_NONE if its chunk does not exist
+	int32 IndexOf(FIntPoint Axial) const {
+		const int32* Slot = ChunkLookup.Find(ChunkOf(Axial));
+		if (Slot == nullptr) {
+			return INDEX_NONE;
+		}
+		return *Slot * GKHEX_CHUNK_AREA + LocalOf(Axial);
+	}
+
+	//! Dense index of a present tile, INDEX_NONE otherwise
+	int32 TileIndexOf(FIntPoint Axial) const {
+		int32 Index = IndexOf(Axial);
+		if (Index == INDEX_NONE || !At(Index).IsPresent()) {
+			return INDEX_NONE;
+		}
+		return Index;
+	}
+
+	FIntPoint AxialOf(int32 Index) const {
+		FIntPoint const& Coord = Chunks[Index / GKHEX_CHUNK_AREA].Coord;
+		int32            Local = Index & (GKHEX_CHUNK_AREA - 1);
+		return FIntPoint((Coord.X << GKHEX_CHUNK_BITS) + (Local & GKHEX_CHUNK_MASK),
+		                 (Coord.Y << GKHEX_CHUNK_BITS) + (Local >> GKHEX_CHUNK_BITS));
+	}
+
+	FGKHexTileData const& At(int32 Index) const {
+		return Chunks[Index / GKHEX_CHUNK_AREA].Tiles[Index & (GKHEX_CHUNK_AREA - 1)];
+	}
+
+	FGKHexTileData& At(int32 Index) {
+		return Chunks[Index / GKHEX_CHUNK_AREA].Tiles[Index & (GKHEX_CHUNK_AREA - 1)];
+	}
+
+	//! Index of the neighbour slot in one of the 6 directions, INDEX_NONE if its chunk does not exist
+	int32 NeighbourOf(int32 Index, int32 Direction) const {
+		int32 Local = Index & (GKHEX_CHUNK_AREA - 1);
+		int32 X     = (Local & GKHEX_CHUNK_MASK) + Directions[Direction].X;
+		int32 Y     = (Local >> GKHEX_CHUNK_BITS) + Directions[Direction].Y;
+
+		// Fast path, we did not leave the chunk
+		if (X >= 0 && X < GKHEX_CHUNK_SIZE && Y >= 0 && Y < GKHEX_CHUNK_SIZE) {
+			return Index - Local + (X | (Y << GKHEX_CHUNK_BITS));
+		}
+		return IndexOf(AxialOf(Index) + Directions[Direction]);
+	}
+
+	//! Returns the tile if present
+	FGKHexTileData const* Find(FIntPoint Axial) const;
+
+	//! Insert a tile, returns its index or INDEX_NONE if the tile already existed
+	int32 Add(FIntPoint Axial, FGKHexTileData const& Tile);
+
+	bool Remove(FIntPoint Axial);
+
+	void Reset();
+
+	//! Take the tiles of another storage, the revision keeps increasing so derived data is invalidated
+	void Replace(FGKHexGridStorage&& Other);
+
+	//! Make sure the chunks covering [Min, Max] exist, used before bulk insertion
+	void ReserveArea(FIntPoint Min, FIntPoint Max);
+
+	/** Save or load the chunks
+	 *
+	 * Chunks are plain data and are written as a single memory block,
+	 * loading is a single read followed by the rebuild of the chunk lookup.
+	 * Loaded chunks are validated (coordinates, duplicates, tile counts),
+	 * the archive is set in error and the storage left empty if they are not.
+	 */
+	void Serialize(FArchive& Ar);
+
+	//! Number of present tiles
+	int32 Num() const { return TileCount; }
+
+	//! Size that an array needs to be to be aligned with the storage
+	int32 GetIndexCount() const { return Chunks.Num() * GKHEX_CHUNK_AREA; }
+
+	int32 GetChunkSlot(FIntPoint ChunkCoord) const {
+		const int32* Slot = ChunkLookup.Find(ChunkCoord);
+		return Slot != nullptr ? *Slot : INDEX_NONE;
+	}
+
+	TArray<FGKHexChunk> const& GetChunks() const { return Chunks; }
+
+	//! Incremented each time tiles are changed, used to invalidate derived data
+	uint32 GetRevision() const { return Revision; }
+
+	void BumpRevision() { Revision += 1; }
+
+	//! The 6 neighbours offsets in axial coordinates
+	static const FIntPoint Directions[6];
+
+private:
+	int32 FindOrAddChunk(FIntPoint ChunkCoord);
+
+	TArray<FGKHexChunk>    Chunks;
+	TMap<FIntPoint, int32> ChunkLookup;
+	int32                  TileCount = 0;
+	uint32                 Revision  = 0;
+};
@@ -4,11 +4,22 @@
 // All rights reserved.
 
 #include "Grid/GKHexGridUtilities.h"
+#include "Grid/GKHexPathfinding.h"
 
 #include "Engine/StaticMesh.h"
 
 #include <cmath>
 
+// FGKHexGridConstants scalar conversions must round exactly like the vectorized ones,
+// forbid the compiler from fusing multiply and add (FMA targets, e.g. ARM64)
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
 // using Vec2 = FVector2D
 // using Vec2i = FIntPoint
 // using Vec3 = FVector
@@ -86,6 +97,167 @@ FVector UGKHexGridUtilities::GridToWorld(FVector2D size, FIntVector map) {
 	return FVector(x, y, float(map.Z) * size.Y);
 }
 
+FGKHexGridConstants::FGKHexGridConstants(FVector2D Size) {
+	QX     = float(sqrt(3.) / 3. / Size.X);
+	QY     = float(-1. / 3. / Size.X);
+	RY     = float(2. / 3. / Size.X);
+	ZZ     = float(1. / Size.Y);
+	XQ     = float(sqrt(3.) * Size.X);
+	XR     = float(sqrt(3.) / 2. * Size.X);
+	YR     = float(3. / 2. * Size.X);
+	Height = Size.Y;
+}
+
+// Contraction is disabled for this file, the statements follow the order of the batch version
+FIntVector FGKHexGridConstants::WorldToGrid(FVector World) const {
+	float QA = World.X * QX;
+	float QB = World.Y * QY;
+	float Q  = QA + QB;
+	float R  = World.Y * RY;
+	float Z  = World.Z * ZZ;
+
+	// Cube round
+	float CY     = -Q - R;
+	float RoundX = RoundHalfAway(Q);
+	float RoundY = RoundHalfAway(CY);
+	float RoundZ = RoundHalfAway(R);
+
+	float DX = FMath::Abs(RoundX - Q);
+	float DY = FMath::Abs(RoundY - CY);
+	float DZ = FMath::Abs(RoundZ - R);
+
+	if (DX > DY && DX > DZ) {
+		RoundX = -RoundY - RoundZ;
+	} else if (!(DY > DZ)) {
+		RoundZ = -RoundX - RoundY;
+	}
+
+	return FIntVector(int32(RoundX), int32(RoundZ), int32(RoundHalfAway(Z)));
+}
+
+FVector FGKHexGridConstants::GridToWorld(FIntVector Grid) const {
+	float XA = float(Grid.X) * XQ;
+	float XB = float(Grid.Y) * XR;
+	float X  = XA + XB;
+	float Y  = float(Grid.Y) * YR;
+	return FVector(X, Y, float(Grid.Z) * Height);
+}
+
+void UGKHexGridUtilities::WorldToGridBatch(FGKHexGridConstants const& Constants, TArrayView<const FVector> World, TArrayView<FIntVector> Grid) {
+	check(Grid.Num() >= World.Num());
+
+	const VectorRegister QX       = VectorSetFloat1(Constants.QX);
+	const VectorRegister QY       = VectorSetFloat1(Constants.QY);
+	const VectorRegister RY       = VectorSetFloat1(Constants.RY);
+	const VectorRegister ZZ       = VectorSetFloat1(Constants.ZZ);
+	const VectorRegister Zero     = VectorZero();
+	const VectorRegister Half     = VectorSetFloat1(0.5f);
+	const VectorRegister One      = VectorOne();
+	const VectorRegister MinusOne = VectorSetFloat1(-1.f);
+
+	// Same as FGKHexGridConstants::RoundHalfAway
+	auto Round = [&](VectorRegister Value) {
+		VectorRegister Truncated = VectorTruncate(Value);
+		VectorRegister Sign      = VectorSelect(VectorCompareGT(Zero, Value), MinusOne, One);
+		VectorRegister Adjust    = VectorSelect(VectorCompareGE(VectorAbs(VectorSubtract(Value, Truncated)), Half), Sign, Zero);
+		return VectorAdd(Truncated, Adjust);
+	};
+
+	MS_ALIGN(16) float OutQ[4] GCC_ALIGN(16);
+	MS_ALIGN(16) float OutR[4] GCC_ALIGN(16);
+	MS_ALIGN(16) float OutZ[4] GCC_ALIGN(16);
+
+	int32 Count = World.Num();
+	int32 i     = 0;
+
+	for (; i + 4 <= Count; i += 4) {
+		FVector const* P = World.GetData() + i;
+
+		VectorRegister WX = MakeVectorRegister(P[0].X, P[1].X, P[2].X, P[3].X);
+		VectorRegister WY = MakeVectorRegister(P[0].Y, P[1].Y, P[2].Y, P[3].Y);
+		VectorRegister WZ = MakeVectorRegister(P[0].Z, P[1].Z, P[2].Z, P[3].Z);
+
+		VectorRegister Q = VectorAdd(VectorMultiply(WX, QX), VectorMultiply(WY, QY));
+		VectorRegister R = VectorMultiply(WY, RY);
+		VectorRegister Z = VectorMultiply(WZ, ZZ);
+
+		// Cube round
+		VectorRegister CY     = VectorSubtract(VectorNegate(Q), R);
+		VectorRegister RoundX = Round(Q);
+		VectorRegister RoundY = Round(CY);
+		VectorRegister RoundZ = Round(R);
+
+		VectorRegister DX = VectorAbs(VectorSubtract(RoundX, Q));
+		VectorRegister DY = VectorAbs(VectorSubtract(RoundY, CY));
+		VectorRegister DZ = VectorAbs(VectorSubtract(RoundZ, R));
+
+		// if (DX > DY && DX > DZ) fix X, else if (!(DY > DZ)) fix Z
+		VectorRegister FixX   = VectorBitwiseAnd(VectorCompareGT(DX, DY), VectorCompareGT(DX, DZ));
+		VectorRegister FixedZ = VectorSelect(VectorCompareGT(DY, DZ), RoundZ, VectorSubtract(VectorNegate(RoundX), RoundY));
+
+		VectorRegister FinalX = VectorSelect(FixX, VectorSubtract(VectorNegate(RoundY), RoundZ), RoundX);
+		VectorRegister FinalZ = VectorSelect(FixX, RoundZ, FixedZ);
+
+		VectorStoreAligned(FinalX, OutQ);
+		VectorStoreAligned(FinalZ, OutR);
+		VectorStoreAligned(Round(Z), OutZ);
+
+		for (int32 j = 0; j < 4; j++) {
+			Grid[i + j] = FIntVector(int32(OutQ[j]), int32(OutR[j]), int32(OutZ[j]));
+		}
+	}
+
+	for (; i < Count; i++) {
+		Grid[i] = Constants.WorldToGrid(World[i]);
+	}
+}
+
+void UGKHexGridUtilities::GridToWorldBatch(FGKHexGridConstants const& Constants, TArrayView<const FIntVector> Grid, TArrayView<FVector> World) {
+	check(World.Num() >= Grid.Num());
+
+	const VectorRegister XQ     = VectorSetFloat1(Constants.XQ);
+	const VectorRegister XR     = VectorSetFloat1(Constants.XR);
+	const VectorRegister YR     = VectorSetFloat1(Constants.YR);
+	const VectorRegister Height = VectorSetFloat1(Constants.Height);
+
+	MS_ALIGN(16) float OutX[4] GCC_ALIGN(16);
+	MS_ALIGN(16) float OutY[4] GCC_ALIGN(16);
+	MS_ALIGN(16) float OutZ[4] GCC_ALIGN(16);
+
+	int32 Count = Grid.Num();
+	int32 i     = 0;
+
+	for (; i + 4 <= Count; i += 4) {
+		FIntVector const* P = Grid.GetData() + i;
+
+		VectorRegister Q = MakeVectorRegister(float(P[0].X), float(P[1].X), float(P[2].X), float(P[3].X));
+		VectorRegister R = MakeVectorRegister(float(P[0].Y), float(P[1].Y), float(P[2].Y), float(P[3].Y));
+		VectorRegister Z = MakeVectorRegister(float(P[0].Z), float(P[1].Z), float(P[2].Z), float(P[3].Z));
+
+		VectorStoreAligned(VectorAdd(VectorMultiply(Q, XQ), VectorMultiply(R, XR)), OutX);
+		VectorStoreAligned(VectorMultiply(R, YR), OutY);
+		VectorStoreAligned(VectorMultiply(Z, Height), OutZ);
+
+		for (int32 j = 0; j < 4; j++) {
+			World[i + j] = FVector(OutX[j], OutY[j], OutZ[j]);
+		}
+	}
+
+	for (; i < Count; i++) {
+		World[i] = Constants.GridToWorld(Grid[i]);
+	}
+}
+
+void UGKHexGridUtilities::WorldToGridArray(FVector2D size, TArray<FVector> const& World, TArray<FIntVector>& Grid) {
+	Grid.SetNumUninitialized(World.Num());
+	WorldToGridBatch(FGKHexGridConstants(size), World, Grid);
+}
+
+void UGKHexGridUtilities::GridToWorldArray(FVector2D size, TArray<FIntVector> const& Grid, TArray<FVector>& World) {
+	World.SetNumUninitialized(Grid.Num());
+	GridToWorldBatch(FGKHexGridConstants(size), Grid, World);
+}
+
 FVector UGKHexGridUtilities::SnapToGrid(FVector2D size, FVector world) {
 	return GridToWorld(size, WorldToGrid(size, world));
 }
@@ -108,3 +280,151 @@ float UGKHexGridUtilities::Distance(FIntPoint a, FIntPoint b) {
 	auto bb = AxialToCube(b);
 	return ::Distance(FIntVector(aa.X, aa.Y, aa.Z), FIntVector(bb.X, bb.Y, bb.Z));
 }
+
+FGKHexRingIterator::FGKHexRingIterator(FIntPoint InCenter, int32 InRadius):
+	Current(InCenter + FGKHexGridStorage::Directions[4] * InRadius), Radius(InRadius), Side(InRadius < 0 ? 6 : 0), Step(0)
+{}
+
+FGKHexRingIterator& FGKHexRingIterator::operator++() {
+	// Ring of radius 0 is the center itself
+	if (Radius == 0) {
+		Side = 6;
+		return *this;
+	}
+
+	Current += FGKHexGridStorage::Directions[Side];
+	Step += 1;
+
+	if (Step == Radius) {
+		Step = 0;
+		Side += 1;
+	}
+	return *this;
+}
+
+FGKHexSpiralIterator::FGKHexSpiralIterator(FIntPoint InCenter, int32 InRadius):
+	Center(InCenter), Radius(InRadius), CurrentRadius(0), Ring(InCenter, 0)
+{}
+
+FGKHexSpiralIterator& FGKHexSpiralIterator::operator++() {
+	++Ring;
+
+	if (!Ring) {
+		CurrentRadius += 1;
+		Ring = FGKHexRingIterator(Center, CurrentRadius);
+	}
+	return *this;
+}
+
+FGKHexRangeIterator::FGKHexRangeIterator(FIntPoint Center, int32 Radius):
+	FGKHexRangeIterator(Center, Radius, Center, Radius)
+{}
+
+FGKHexRangeIterator::FGKHexRangeIterator(FIntPoint A, int32 RadiusA, FIntPoint B, int32 RadiusB) {
+	// Intersect the cube coordinate bounds of both ranges
+	QMin = FMath::Max(A.X - RadiusA, B.X - RadiusB);
+	QMax = FMath::Min(A.X + RadiusA, B.X + RadiusB);
+	RMin = FMath::Max(A.Y - RadiusA, B.Y - RadiusB);
+	RMax = FMath::Min(A.Y + RadiusA, B.Y + RadiusB);
+	SMin = FMath::Max(-A.X - A.Y - RadiusA, -B.X - B.Y - RadiusB);
+	SMax = FMath::Min(-A.X - A.Y + RadiusA, -B.X - B.Y + RadiusB);
+
+	Q = QMin;
+	StartColumn();
+}
+
+void FGKHexRangeIterator::StartColumn() {
+	for (; Q <= QMax; Q++) {
+		R    = FMath::Max(RMin, -Q - SMax);
+		REnd = FMath::Min(RMax, -Q - SMin);
+
+		if (R <= REnd) {
+			return;
+		}
+	}
+}
+
+FGKHexRangeIterator& FGKHexRangeIterator::operator++() {
+	R += 1;
+
+	if (R > REnd) {
+		Q += 1;
+		StartColumn();
+	}
+	return *this;
+}
+
+FGKHexLineIterator::FGKHexLineIterator(FIntPoint A, FIntPoint B) {
+	Origin  = A;
+	Delta   = B - A;
+	Count   = FGKHexPathfinder::Distance(A, B);
+	Step    = 0;
+	Current = A;
+}
+
+void FGKHexLineIterator::Evaluate() {
+	// Interpolate relative to the origin in double precision so the nudge survives on large maps
+	// it makes points falling exactly on an edge always round the same way
+	double T = double(Step) / double(Count);
+	double X = double(Delta.X) * T + 1e-6;
+	double Z = double(Delta.Y) * T - 3e-6;
+	double Y = double(-Delta.X - Delta.Y) * T + 2e-6;
+
+	int32 RX = int32(round(X));
+	int32 RY = int32(round(Y));
+	int32 RZ = int32(round(Z));
+
+	double XDiff = FMath::Abs(RX - X);
+	double YDiff = FMath::Abs(RY - Y);
+	double ZDiff = FMath::Abs(RZ - Z);
+
+	if (XDiff > YDiff && XDiff > ZDiff) {
+		RX = -RY - RZ;
+	} else if (YDiff <= ZDiff) {
+		RZ = -RX - RY;
+	}
+
+	Current = Origin + FIntPoint(RX, RZ);
+}
+
+FGKHexLineIterator& FGKHexLineIterator::operator++() {
+	Step += 1;
+
+	if (Step <= Count) {
+		Evaluate();
+	}
+	return *this;
+}
+
+void UGKHexGridUtilities::HexRing(FIntPoint Center, int Radius, TArray<FIntPoint>& Tiles) {
+	Tiles.Reset(FGKHexRingIterator::Num(FMath::Max(Radius, 0)));
+
+	for (FGKHexRingIterator It(Center, Radius); It; ++It) {
+		Tiles.Add(*It);
+	}
+}
+
+void UGKHexGridUtilities::HexSpiral(FIntPoint Center, int Radius, TArray<FIntPoint>& Tiles) {
+	Tiles.Reset(FGKHexSpiralIterator::Num(FMath::Max(Radius, 0)));
+
+	for (FGKHexSpiralIterator It(Center, Radius); It; ++It) {
+		Tiles.Add(*It);
+	}
+}
+
+void UGKHexGridUtilities::HexRangeIntersection(FIntPoint A, int RadiusA, FIntPoint B, int RadiusB, TArray<FIntPoint>& Tiles) {
+	Tiles.Reset();
+
+	for (FGKHexRangeIterator It(A, RadiusA, B, RadiusB); It; ++It) {
+		Tiles.Add(*It);
+	}
+}
+
+void UGKHexGridUtilities::HexLine(FIntPoint A, FIntPoint B, TArray<FIntPoint>& Tiles) {
+	FGKHexLineIterator It(A, B);
+	Tiles.Reset(It.Num());
+
+	for (; It; ++It) {
+		Tiles.Add(*It);
+	}
+}
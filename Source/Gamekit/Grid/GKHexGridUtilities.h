@@ -8,8 +8,139 @@
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 
+#include "Grid/GKHexGridStorage.h"
+
 #include "GKHexGridUtilities.generated.h"
 
+/** Pointy hex conversion constants precomputed for a given tile size
+ *
+ * The scalar conversions of this struct and the batch conversions use the exact same float operations
+ * (same rounding, floating point contraction is disabled in the translation unit)
+ * so they return identical results.
+ * UGKHexGridUtilities::WorldToGrid/GridToWorld compute in double precision
+ * and can differ on tile boundaries.
+ */
+struct GAMEKIT_API FGKHexGridConstants
+{
+	FGKHexGridConstants(FVector2D Size);
+
+	// World to grid
+	float QX; // sqrt(3) / 3 / Radius
+	float QY; // -1 / 3 / Radius
+	float RY; // 2 / 3 / Radius
+	float ZZ; // 1 / Height
+
+	// Grid to world
+	float XQ; // sqrt(3) * Radius
+	float XR; // sqrt(3) / 2 * Radius
+	float YR; // 3 / 2 * Radius
+	float Height;
+
+	//! Float reference of WorldToGridBatch
+	FIntVector WorldToGrid(FVector World) const;
+
+	//! Float reference of GridToWorldBatch
+	FVector GridToWorld(FIntVector Grid) const;
+
+	//! Round half away from zero, matches the vectorized rounding bit for bit
+	static float RoundHalfAway(float Value) {
+		float Truncated = float(int32(Value));
+		if (FMath::Abs(Value - Truncated) >= 0.5f) {
+			Truncated += Value < 0.f ? -1.f : 1.f;
+		}
+		return Truncated;
+	}
+};
+
+/** Iterate over the tiles at exactly Radius from Center (axial coordinates)
+ *
+ * for (FGKHexRingIterator It(Center, Radius); It; ++It) { FIntPoint Tile = *It; }
+ */
+struct GAMEKIT_API FGKHexRingIterator
+{
+	FGKHexRingIterator(FIntPoint InCenter, int32 InRadius);
+
+	explicit operator bool() const { return Side < 6; }
+
+	FIntPoint operator*() const { return Current; }
+
+	FGKHexRingIterator& operator++();
+
+	//! Number of tiles in a ring
+	static int32 Num(int32 Radius) { return Radius == 0 ? 1 : 6 * Radius; }
+
+private:
+	FIntPoint Current;
+	int32     Radius;
+	int32     Side;
+	int32     Step;
+};
+
+//! Iterate over the tiles within Radius of Center, ring by ring starting from the center
+struct GAMEKIT_API FGKHexSpiralIterator
+{
+	FGKHexSpiralIterator(FIntPoint InCenter, int32 InRadius);
+
+	explicit operator bool() const { return CurrentRadius <= Radius; }
+
+	FIntPoint operator*() const { return *Ring; }
+
+	FGKHexSpiralIterator& operator++();
+
+	//! Number of tiles within Radius
+	static int32 Num(int32 Radius) { return 1 + 3 * Radius * (Radius + 1); }
+
+private:
+	FIntPoint          Center;
+	int32              Radius;
+	int32              CurrentRadius;
+	FGKHexRingIterator Ring;
+};
+
+//! Iterate over the tiles within RadiusA of A and RadiusB of B
+struct GAMEKIT_API FGKHexRangeIterator
+{
+	FGKHexRangeIterator(FIntPoint Center, int32 Radius);
+
+	FGKHexRangeIterator(FIntPoint A, int32 RadiusA, FIntPoint B, int32 RadiusB);
+
+	explicit operator bool() const { return Q <= QMax; }
+
+	FIntPoint operator*() const { return FIntPoint(Q, R); }
+
+	FGKHexRangeIterator& operator++();
+
+private:
+	void StartColumn();
+
+	int32 QMin, QMax, RMin, RMax, SMin, SMax;
+	int32 Q, R, REnd;
+};
+
+//! Iterate over the tiles on the straight line between A and B (both included)
+struct GAMEKIT_API FGKHexLineIterator
+{
+	FGKHexLineIterator(FIntPoint A, FIntPoint B);
+
+	explicit operator bool() const { return Step <= Count; }
+
+	FIntPoint operator*() const { return Current; }
+
+	FGKHexLineIterator& operator++();
+
+	//! Number of tiles on the line
+	int32 Num() const { return Count + 1; }
+
+private:
+	void Evaluate();
+
+	FIntPoint Origin;
+	FIntPoint Delta;
+	FIntPoint Current;
+	int32     Count;
+	int32     Step;
+};
+
 /**
  *
  */
@@ -43,6 +174,22 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Hex|Axial;Hex|Pointy")
 	static FVector GridToWorld(FVector2D size, FIntVector map);
 
+	//! Convert a batch of world positions to grid positions 4 at a time using SIMD
+	//! Matches FGKHexGridConstants::WorldToGrid, Grid must be at least as big as World
+	static void WorldToGridBatch(FGKHexGridConstants const& Constants, TArrayView<const FVector> World, TArrayView<FIntVector> Grid);
+
+	//! Convert a batch of grid positions to world positions 4 at a time using SIMD
+	//! Matches FGKHexGridConstants::GridToWorld, World must be at least as big as Grid
+	static void GridToWorldBatch(FGKHexGridConstants const& Constants, TArrayView<const FIntVector> Grid, TArrayView<FVector> World);
+
+	//! Blueprint version of WorldToGridBatch
+	UFUNCTION(BlueprintCallable, Category="Hex|Axial;Hex|Pointy")
+	static void WorldToGridArray(FVector2D size, TArray<FVector> const& World, UPARAM(ref) TArray<FIntVector>& Grid);
+
+	//! Blueprint version of GridToWorldBatch
+	UFUNCTION(BlueprintCallable, Category="Hex|Axial;Hex|Pointy")
+	static void GridToWorldArray(FVector2D size, TArray<FIntVector> const& Grid, UPARAM(ref) TArray<FVector>& World);
+
 	/** Snap word coordinate to compatible grid-world coordinate
 	 * size is a 2D vector using X as radius and Y as height
 	 */
@@ -59,4 +206,20 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category="Hex|Axial")
 	static float Distance(FIntPoint a, FIntPoint b);
+
+	//! Fill Tiles with the tiles at exactly Radius from Center
+	UFUNCTION(BlueprintCallable, Category="Hex|Axial")
+	static void HexRing(FIntPoint Center, int Radius, UPARAM(ref) TArray<FIntPoint>& Tiles);
+
+	//! Fill Tiles with the tiles within Radius of Center, closest first
+	UFUNCTION(BlueprintCallable, Category="Hex|Axial")
+	static void HexSpiral(FIntPoint Center, int Radius, UPARAM(ref) TArray<FIntPoint>& Tiles);
+
+	//! Fill Tiles with the tiles within RadiusA of A and RadiusB of B
+	UFUNCTION(BlueprintCallable, Category="Hex|Axial")
+	static void HexRangeIntersection(FIntPoint A, int RadiusA, FIntPoint B, int RadiusB, UPARAM(ref) TArray<FIntPoint>& Tiles);
+
+	//! Fill Tiles with the tiles on the line between A and B
+	UFUNCTION(BlueprintCallable, Category="Hex|Axial")
+	static void HexLine(FIntPoint A, FIntPoint B, UPARAM(ref) TArray<FIntPoint>& Tiles);
 };
@@ -0,0 +1,59 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#include "Grid/GKHexOccupancy.h"
+
+#include "HAL/PlatformAtomics.h"
+
+bool FGKHexOccupancy::Reserve(int32 Index, int32 Owner) {
+	if (!Occupants.IsValidIndex(Index) || Owner == GKHEX_NO_OCCUPANT) {
+		return false;
+	}
+
+	int32 Previous = FPlatformAtomics::InterlockedCompareExchange(&Occupants[Index], Owner, GKHEX_NO_OCCUPANT);
+
+	if (Previous == GKHEX_NO_OCCUPANT) {
+		FPlatformAtomics::InterlockedIncrement(&Revision);
+		return true;
+	}
+	return Previous == Owner;
+}
+
+bool FGKHexOccupancy::Release(int32 Index, int32 Owner) {
+	if (!Occupants.IsValidIndex(Index) || Owner == GKHEX_NO_OCCUPANT) {
+		return false;
+	}
+
+	if (FPlatformAtomics::InterlockedCompareExchange(&Occupants[Index], GKHEX_NO_OCCUPANT, Owner) != Owner) {
+		return false;
+	}
+
+	FPlatformAtomics::InterlockedIncrement(&Revision);
+	return true;
+}
+
+bool FGKHexOccupancy::Move(int32 From, int32 To, int32 Owner) {
+	if (!Reserve(To, Owner)) {
+		return false;
+	}
+
+	if (From != To) {
+		Release(From, Owner);
+	}
+	return true;
+}
+
+void FGKHexOccupancy::ReleaseAll(int32 Owner) {
+	for (int32 Index = 0; Index < Occupants.Num(); Index++) {
+		if (Occupants[Index] == Owner) {
+			Release(Index, Owner);
+		}
+	}
+}
+
+int32 FGKHexOccupancy::Num() const {
+	int32 Count = 0;
+	for (int32 Occupant: Occupants) {
+		Count += Occupant != GKHEX_NO_OCCUPANT;
+	}
+	return Count;
+}
@@ -0,0 +1,64 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Owner of a free tile
+#define GKHEX_NO_OCCUPANT 0
+
+/** Who stands on (or is moving to) each tile, aligned with FGKHexGridStorage indices
+ *
+ * Reserve and Release are atomic so units can claim their destination
+ * from any thread, the first one to reserve a tile wins.
+ * Growing the layer (Sync) is not thread safe and happens on the game thread
+ * when tiles are added.
+ */
+class GAMEKIT_API FGKHexOccupancy
+{
+public:
+	//! Grow the layer to match the storage index count, new tiles are free
+	void Sync(int32 IndexCount) {
+		if (Occupants.Num() < IndexCount) {
+			Occupants.SetNumZeroed(IndexCount);
+		}
+	}
+
+	void Reset() {
+		Occupants.Reset();
+		Revision += 1;
+	}
+
+	//! Occupant of the tile, GKHEX_NO_OCCUPANT if free
+	int32 GetOccupant(int32 Index) const {
+		return Occupants.IsValidIndex(Index) ? Occupants[Index] : GKHEX_NO_OCCUPANT;
+	}
+
+	//! Tile is free or already held by Owner
+	bool IsFree(int32 Index, int32 Owner) const {
+		int32 Occupant = GetOccupant(Index);
+		return Occupant == GKHEX_NO_OCCUPANT || Occupant == Owner;
+	}
+
+	//! Claim a tile, returns true if Owner holds the tile afterwards
+	bool Reserve(int32 Index, int32 Owner);
+
+	//! Free a tile held by Owner, returns false if Owner did not hold it
+	bool Release(int32 Index, int32 Owner);
+
+	//! Reserve To then release From, nothing changes if To is taken
+	bool Move(int32 From, int32 To, int32 Owner);
+
+	//! Release every tile held by Owner
+	void ReleaseAll(int32 Owner);
+
+	//! Number of occupied tiles
+	int32 Num() const;
+
+	//! Incremented each time a tile changes occupant, used to invalidate cached paths
+	int32 GetRevision() const { return Revision; }
+
+private:
+	TArray<int32> Occupants;
+	int32         Revision = 0;
+};
@@ -0,0 +1,114 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#include "Grid/GKHexPathCache.h"
+
+void FGKHexPathCache::SetCapacity(int32 InCapacity) {
+	Capacity = FMath::Max(InCapacity, 0);
+	Reset();
+}
+
+void FGKHexPathCache::Reset() {
+	Entries.Reset();
+	Entries.SetNum(Capacity);
+	Lookup.Reset();
+	Lookup.Reserve(Capacity);
+
+	// Pop from the back so slots are used in order
+	FreeSlots.Reset(Capacity);
+	for (int32 Slot = Capacity - 1; Slot >= 0; Slot--) {
+		FreeSlots.Add(Slot);
+	}
+
+	Head = INDEX_NONE;
+	Tail = INDEX_NONE;
+}
+
+void FGKHexPathCache::Unlink(int32 Slot) {
+	FEntry& Entry = Entries[Slot];
+
+	if (Entry.Prev != INDEX_NONE) {
+		Entries[Entry.Prev].Next = Entry.Next;
+	} else {
+		Head = Entry.Next;
+	}
+
+	if (Entry.Next != INDEX_NONE) {
+		Entries[Entry.Next].Prev = Entry.Prev;
+	} else {
+		Tail = Entry.Prev;
+	}
+
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = INDEX_NONE;
+}
+
+void FGKHexPathCache::PushFront(int32 Slot) {
+	FEntry& Entry = Entries[Slot];
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = Head;
+
+	if (Head != INDEX_NONE) {
+		Entries[Head].Prev = Slot;
+	} else {
+		Tail = Slot;
+	}
+	Head = Slot;
+}
+
+void FGKHexPathCache::Remove(int32 Slot) {
+	Unlink(Slot);
+	Lookup.Remove(Entries[Slot].Key);
+	FreeSlots.Add(Slot);
+}
+
+FGKHexCachedPath const* FGKHexPathCache::Find(FGKHexPathKey const& Key, uint64 Revision) {
+	int32 const* Slot = Lookup.Find(Key);
+
+	if (Slot == nullptr) {
+		Misses += 1;
+		return nullptr;
+	}
+
+	int32 Found = *Slot;
+	if (Entries[Found].Revision != Revision) {
+		Remove(Found);
+		Misses += 1;
+		return nullptr;
+	}
+
+	if (Found != Head) {
+		Unlink(Found);
+		PushFront(Found);
+	}
+
+	Hits += 1;
+	return &Entries[Found].Result;
+}
+
+void FGKHexPathCache::Add(FGKHexPathKey const& Key, uint64 Revision, TArray<int32> const& Path, bool bFound) {
+	if (Capacity == 0) {
+		return;
+	}
+
+	int32 Slot = INDEX_NONE;
+
+	if (int32 const* Existing = Lookup.Find(Key)) {
+		Slot = *Existing;
+		Unlink(Slot);
+	} else {
+		if (FreeSlots.Num() == 0) {
+			Remove(Tail);
+			Evictions += 1;
+		}
+
+		Slot = FreeSlots.Pop(false);
+		Lookup.Add(Key, Slot);
+	}
+
+	FEntry& Entry       = Entries[Slot];
+	Entry.Key           = Key;
+	Entry.Revision      = Revision;
+	Entry.Result.bFound = bFound;
+	Entry.Result.Path   = Path;
+	PushFront(Slot);
+}
@@ -0,0 +1,86 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FGKHexPathKey
+{
+	int32 Start;   // Storage index
+	int32 Goal;    // Storage index
+	int32 Profile; // Cost model used by the search
+
+	bool operator==(FGKHexPathKey const& Other) const {
+		return Start == Other.Start && Goal == Other.Goal && Profile == Other.Profile;
+	}
+
+	friend inline uint32 GetTypeHash(FGKHexPathKey const& Key) {
+		return HashCombine(HashCombine(uint32(Key.Start), uint32(Key.Goal)), uint32(Key.Profile));
+	}
+};
+
+struct FGKHexCachedPath
+{
+	TArray<int32> Path;
+	bool          bFound = false;
+};
+
+/** Least recently used cache of path search results
+ *
+ * Entries are tagged with the revision of the data the search used,
+ * entries with an older revision are dropped when they are looked up.
+ * Failed searches are cached as well.
+ */
+class GAMEKIT_API FGKHexPathCache
+{
+public:
+	int32 GetCapacity() const { return Capacity; }
+
+	//! Change the number of paths kept, 0 disables the cache
+	void SetCapacity(int32 InCapacity);
+
+	//! Returns the cached result, nullptr if missing or stale
+	FGKHexCachedPath const* Find(FGKHexPathKey const& Key, uint64 Revision);
+
+	//! Insert a search result, evicting the least recently used entry when full
+	void Add(FGKHexPathKey const& Key, uint64 Revision, TArray<int32> const& Path, bool bFound);
+
+	void Reset();
+
+	void ResetStats() { Hits = Misses = Evictions = 0; }
+
+	int32 Num() const { return Lookup.Num(); }
+
+	int32 GetHits() const { return Hits; }
+
+	int32 GetMisses() const { return Misses; }
+
+	int32 GetEvictions() const { return Evictions; }
+
+private:
+	struct FEntry
+	{
+		FGKHexPathKey    Key;
+		uint64           Revision = 0;
+		FGKHexCachedPath Result;
+		int32            Prev = INDEX_NONE;
+		int32            Next = INDEX_NONE;
+	};
+
+	void Unlink(int32 Slot);
+
+	void PushFront(int32 Slot);
+
+	//! Unlink the entry and make its slot available
+	void Remove(int32 Slot);
+
+	TArray<FEntry>             Entries; // Fixed pool of Capacity entries
+	TArray<int32>              FreeSlots;
+	TMap<FGKHexPathKey, int32> Lookup;
+	int32                      Head      = INDEX_NONE; // Most recently used
+	int32                      Tail      = INDEX_NONE; // Least recently used
+	int32                      Capacity  = 0;
+	int32                      Hits      = 0;
+	int32                      Misses    = 0;
+	int32                      Evictions = 0;
+};
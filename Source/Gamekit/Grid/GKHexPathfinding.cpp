@@ -0,0 +1,510 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#include "Grid/GKHexPathfinding.h"
+
+#include "Algo/Reverse.h"
+
+void FGKHexSearchScratch::Prepare(int32 IndexCount) {
+	if (Stamp.Num() < IndexCount) {
+		Cost.SetNumUninitialized(IndexCount);
+		Parent.SetNumUninitialized(IndexCount);
+		Order.SetNumUninitialized(IndexCount);
+		Stamp.SetNumZeroed(IndexCount);
+	}
+
+	Open.Reset();
+	Generation += 1;
+
+	// Generation wrapped around, stamps cannot be trusted anymore
+	if (Generation == 0) {
+		FMemory::Memzero(Stamp.GetData(), Stamp.Num() * sizeof(uint32));
+		Generation = 1;
+	}
+}
+
+void FGKHexSearchScratch::Reconstruct(int32 Index, TArray<int32>& OutPath) const {
+	OutPath.Reset();
+
+	while (Index != INDEX_NONE) {
+		OutPath.Add(Index);
+		Index = Parent[Index];
+	}
+
+	Algo::Reverse(OutPath);
+}
+
+bool FGKHexPathfinder::FindPath(FGKHexGridStorage const& Storage,
+                                FGKHexSearchScratch&     Scratch,
+                                int32                    Start,
+                                int32                    Goal,
+                                TArray<int32>&           OutPath,
+                                int32                    ChunkSlot,
+                                FGKHexOccupancy const*   Occupancy,
+                                int32                    Owner)
+{
+	OutPath.Reset();
+
+	if (Start == INDEX_NONE || Goal == INDEX_NONE || !Storage.At(Goal).IsWalkable()) {
+		return false;
+	}
+
+	if (Occupancy != nullptr && !Occupancy->IsFree(Goal, Owner)) {
+		return false;
+	}
+
+	FIntPoint GoalAxial = Storage.AxialOf(Goal);
+
+	Scratch.Prepare(Storage.GetIndexCount());
+	Scratch.Visit(Start, 0, INDEX_NONE);
+	Scratch.Open.HeapPush({Start, 0, Distance(Storage.AxialOf(Start), GoalAxial)});
+
+	while (Scratch.Open.Num() > 0) {
+		FGKHexOpenNode Node;
+		Scratch.Open.HeapPop(Node, false);
+
+		// A cheaper path to this node was found after it was pushed
+		if (Node.Cost != Scratch.Cost[Node.Index]) {
+			continue;
+		}
+
+		if (Node.Index == Goal) {
+			Scratch.Reconstruct(Goal, OutPath);
+			return true;
+		}
+
+		for (int32 Direction = 0; Direction < 6; Direction++) {
+			int32 Neighbour = Storage.NeighbourOf(Node.Index, Direction);
+
+			if (Neighbour == INDEX_NONE || !Storage.At(Neighbour).IsWalkable()) {
+				continue;
+			}
+
+			if (ChunkSlot != INDEX_NONE && Neighbour / GKHEX_CHUNK_AREA != ChunkSlot) {
+				continue;
+			}
+
+			if (Occupancy != nullptr && !Occupancy->IsFree(Neighbour, Owner)) {
+				continue;
+			}
+
+			int32 Cost = Node.Cost + Storage.At(Neighbour).Cost;
+			if (Scratch.IsVisited(Neighbour) && Scratch.Cost[Neighbour] <= Cost) {
+				continue;
+			}
+
+			Scratch.Visit(Neighbour, Cost, Node.Index);
+			Scratch.Open.HeapPush({Neighbour, Cost, Cost + Distance(Storage.AxialOf(Neighbour), GoalAxial)});
+		}
+	}
+
+	return false;
+}
+
+void FGKHexPathfinder::Reachable(FGKHexGridStorage const& Storage,
+                                 FGKHexSearchScratch&     Scratch,
+                                 int32                    Start,
+                                 int32                    Budget,
+                                 FGKHexCostFunction       CostFn,
+                                 TArray<int32>&           OutTiles)
+{
+	OutTiles.Reset();
+
+	if (Start == INDEX_NONE) {
+		return;
+	}
+
+	Scratch.Prepare(Storage.GetIndexCount());
+	Scratch.Visit(Start, 0, INDEX_NONE);
+	Scratch.Open.HeapPush({Start, 0, 0});
+
+	while (Scratch.Open.Num() > 0) {
+		FGKHexOpenNode Node;
+		Scratch.Open.HeapPop(Node, false);
+
+		if (Node.Cost != Scratch.Cost[Node.Index]) {
+			continue;
+		}
+
+		Scratch.Order[Node.Index] = OutTiles.Add(Node.Index);
+
+		for (int32 Direction = 0; Direction < 6; Direction++) {
+			int32 Neighbour = Storage.NeighbourOf(Node.Index, Direction);
+
+			if (Neighbour == INDEX_NONE || !Storage.At(Neighbour).IsPresent()) {
+				continue;
+			}
+
+			int32 Step = CostFn(Node.Index, Neighbour);
+			if (Step < 0) {
+				continue;
+			}
+
+			int32 Cost = Node.Cost + Step;
+			if (Cost > Budget || (Scratch.IsVisited(Neighbour) && Scratch.Cost[Neighbour] <= Cost)) {
+				continue;
+			}
+
+			Scratch.Visit(Neighbour, Cost, Node.Index);
+			Scratch.Open.HeapPush({Neighbour, Cost, Cost});
+		}
+	}
+}
+
+void FGKHexPathfinder::ChunkDistances(FGKHexGridStorage const& Storage,
+                                      FGKHexSearchScratch&     Scratch,
+                                      int32                    Source,
+                                      int32                    ChunkSlot,
+                                      bool                     bReverse)
+{
+	Scratch.Prepare(Storage.GetIndexCount());
+	Scratch.Visit(Source, 0, INDEX_NONE);
+	Scratch.Open.HeapPush({Source, 0, 0});
+
+	while (Scratch.Open.Num() > 0) {
+		FGKHexOpenNode Node;
+		Scratch.Open.HeapPop(Node, false);
+
+		if (Node.Cost != Scratch.Cost[Node.Index]) {
+			continue;
+		}
+
+		// Going backward we pay to enter the current node
+		int32 ReverseCost = Storage.At(Node.Index).Cost;
+
+		for (int32 Direction = 0; Direction < 6; Direction++) {
+			int32 Neighbour = Storage.NeighbourOf(Node.Index, Direction);
+
+			if (Neighbour == INDEX_NONE || Neighbour / GKHEX_CHUNK_AREA != ChunkSlot) {
+				continue;
+			}
+
+			if (!Storage.At(Neighbour).IsWalkable()) {
+				continue;
+			}
+
+			int32 Cost = Node.Cost + (bReverse ? ReverseCost : Storage.At(Neighbour).Cost);
+			if (Scratch.IsVisited(Neighbour) && Scratch.Cost[Neighbour] <= Cost) {
+				continue;
+			}
+
+			Scratch.Visit(Neighbour, Cost, Node.Index);
+			Scratch.Open.HeapPush({Neighbour, Cost, Cost});
+		}
+	}
+}
+
+void FGKHexHierarchy::MarkDirty(FGKHexGridStorage const& Storage, FIntPoint ChunkCoord) {
+	if (Chunks.Num() < Storage.GetChunks().Num()) {
+		Chunks.SetNum(Storage.GetChunks().Num());
+	}
+
+	int32 Slot = Storage.GetChunkSlot(ChunkCoord);
+	if (Slot != INDEX_NONE) {
+		Chunks[Slot].bDirty = true;
+	}
+
+	// Border entrances are shared with the neighbours
+	for (FIntPoint const& Direction: FGKHexGridStorage::Directions) {
+		Slot = Storage.GetChunkSlot(ChunkCoord + Direction);
+		if (Slot != INDEX_NONE) {
+			Chunks[Slot].bDirty = true;
+		}
+	}
+
+	bDirty = true;
+}
+
+void FGKHexHierarchy::MarkAllDirty() {
+	for (FGKHexAbstractChunk& Chunk: Chunks) {
+		Chunk.bDirty = true;
+	}
+	bDirty = true;
+}
+
+void FGKHexHierarchy::Update(FGKHexGridStorage const& Storage) {
+	if (Chunks.Num() != Storage.GetChunks().Num()) {
+		Chunks.SetNum(Storage.GetChunks().Num());
+		bDirty = true;
+	}
+
+	if (!bDirty) {
+		return;
+	}
+
+	for (int32 Slot = 0; Slot < Chunks.Num(); Slot++) {
+		if (Chunks[Slot].bDirty) {
+			RebuildChunk(Storage, AbstractScratch, Slot);
+		}
+	}
+
+	bDirty = false;
+}
+
+int32 FGKHexHierarchy::GetNodeCount() const {
+	int32 Count = 0;
+	for (FGKHexAbstractChunk const& Chunk: Chunks) {
+		Count += Chunk.Nodes.Num();
+	}
+	return Count;
+}
+
+void FGKHexHierarchy::GetTransitions(FGKHexGridStorage const&     Storage,
+                                     int32                        SlotA,
+                                     int32                        SlotB,
+                                     TArray<TPair<int32, int32>>& Out) const
+{
+	Out.Reset();
+
+	// Always scan from the same chunk so both sides agree on the entrances
+	FIntPoint CoordA = Storage.GetChunks()[SlotA].Coord;
+	FIntPoint CoordB = Storage.GetChunks()[SlotB].Coord;
+	bool      bSwap  = CoordB.X < CoordA.X || (CoordB.X == CoordA.X && CoordB.Y < CoordA.Y);
+
+	if (bSwap) {
+		Swap(SlotA, SlotB);
+	}
+
+	TArray<TPair<int32, int32>, TInlineAllocator<GKHEX_CHUNK_SIZE * 2>> Candidates;
+	int32 Base = SlotA * GKHEX_CHUNK_AREA;
+
+	for (int32 Local = 0; Local < GKHEX_CHUNK_AREA; Local++) {
+		int32 X = Local & GKHEX_CHUNK_MASK;
+		int32 Y = Local >> GKHEX_CHUNK_BITS;
+
+		// Interior tiles cannot reach another chunk
+		if (X > 0 && X < GKHEX_CHUNK_MASK && Y > 0 && Y < GKHEX_CHUNK_MASK) {
+			continue;
+		}
+
+		int32 A = Base + Local;
+		if (!Storage.At(A).IsWalkable()) {
+			continue;
+		}
+
+		for (int32 Direction = 0; Direction < 6; Direction++) {
+			int32 B = Storage.NeighbourOf(A, Direction);
+
+			if (B != INDEX_NONE && B / GKHEX_CHUNK_AREA == SlotB && Storage.At(B).IsWalkable()) {
+				Candidates.Emplace(A, B);
+			}
+		}
+	}
+
+	// Group contiguous candidates into entrances, both sides need to be contiguous
+	// or a region of B only reachable through the middle of the run would get no transition
+	int32 RunStart = 0;
+	for (int32 i = 1; i <= Candidates.Num(); i++) {
+		bool bContiguous = i < Candidates.Num() &&
+			FGKHexPathfinder::Distance(Storage.AxialOf(Candidates[i].Key), Storage.AxialOf(Candidates[i - 1].Key)) <= 1 &&
+			FGKHexPathfinder::Distance(Storage.AxialOf(Candidates[i].Value), Storage.AxialOf(Candidates[i - 1].Value)) <= 1;
+
+		if (bContiguous) {
+			continue;
+		}
+
+		// Long entrances get a transition at both ends, short ones in the middle
+		int32 Length = i - RunStart;
+		if (Length >= 6) {
+			Out.Add(Candidates[RunStart]);
+			Out.Add(Candidates[i - 1]);
+		} else {
+			Out.Add(Candidates[RunStart + Length / 2]);
+		}
+		RunStart = i;
+	}
+
+	if (bSwap) {
+		for (TPair<int32, int32>& Transition: Out) {
+			Swap(Transition.Key, Transition.Value);
+		}
+	}
+}
+
+void FGKHexHierarchy::RebuildChunk(FGKHexGridStorage const& Storage, FGKHexSearchScratch& Scratch, int32 Slot) {
+	FGKHexAbstractChunk& Chunk = Chunks[Slot];
+	Chunk.Nodes.Reset();
+	Chunk.Distances.Reset();
+	Chunk.Inter.Reset();
+	Chunk.bDirty = false;
+
+	FGKHexChunk const& Data = Storage.GetChunks()[Slot];
+	if (Data.Count == 0) {
+		return;
+	}
+
+	TArray<TPair<int32, int32>> Transitions;
+	for (FIntPoint const& Direction: FGKHexGridStorage::Directions) {
+		int32 Neighbour = Storage.GetChunkSlot(Data.Coord + Direction);
+		if (Neighbour == INDEX_NONE) {
+			continue;
+		}
+
+		GetTransitions(Storage, Slot, Neighbour, Transitions);
+
+		for (TPair<int32, int32> const& Transition: Transitions) {
+			int32 Node = Chunk.Nodes.AddUnique(Transition.Key);
+			if (Node == Chunk.Inter.Num()) {
+				Chunk.Inter.AddDefaulted();
+			}
+			Chunk.Inter[Node].Add({Transition.Value, Storage.At(Transition.Value).Cost});
+		}
+	}
+
+	int32 Count = Chunk.Nodes.Num();
+	Chunk.Distances.Init(MAX_int32, Count * Count);
+
+	for (int32 i = 0; i < Count; i++) {
+		FGKHexPathfinder::ChunkDistances(Storage, Scratch, Chunk.Nodes[i], Slot);
+
+		for (int32 j = 0; j < Count; j++) {
+			if (Scratch.IsVisited(Chunk.Nodes[j])) {
+				Chunk.Distances[i * Count + j] = Scratch.Cost[Chunk.Nodes[j]];
+			}
+		}
+	}
+}
+
+bool FGKHexHierarchy::FindPath(FGKHexGridStorage const& Storage,
+                               FGKHexSearchScratch&     Scratch,
+                               int32                    Start,
+                               int32                    Goal,
+                               TArray<int32>&           OutPath,
+                               FGKHexOccupancy const*   Occupancy,
+                               int32                    Owner)
+{
+	OutPath.Reset();
+
+	if (Start == INDEX_NONE || Goal == INDEX_NONE || !Storage.At(Goal).IsWalkable()) {
+		return false;
+	}
+
+	if (Occupancy != nullptr && !Occupancy->IsFree(Goal, Owner)) {
+		return false;
+	}
+
+	Update(Storage);
+
+	int32 StartSlot = Start / GKHEX_CHUNK_AREA;
+	int32 GoalSlot  = Goal / GKHEX_CHUNK_AREA;
+
+	// Same chunk, try a local path first
+	if (StartSlot == GoalSlot && FGKHexPathfinder::FindPath(Storage, Scratch, Start, Goal, OutPath, StartSlot, Occupancy, Owner)) {
+		return true;
+	}
+
+	// Connect Start and Goal to the entrances of their chunks
+	FGKHexAbstractChunk const&       StartChunk = Chunks[StartSlot];
+	FGKHexAbstractChunk const&       GoalChunk  = Chunks[GoalSlot];
+	TArray<int32, TInlineAllocator<32>> StartCosts;
+	TArray<int32, TInlineAllocator<32>> GoalCosts;
+
+	FGKHexPathfinder::ChunkDistances(Storage, Scratch, Start, StartSlot);
+	for (int32 Node: StartChunk.Nodes) {
+		StartCosts.Add(Scratch.IsVisited(Node) ? Scratch.Cost[Node] : MAX_int32);
+	}
+
+	FGKHexPathfinder::ChunkDistances(Storage, Scratch, Goal, GoalSlot, true);
+	for (int32 Node: GoalChunk.Nodes) {
+		GoalCosts.Add(Scratch.IsVisited(Node) ? Scratch.Cost[Node] : MAX_int32);
+	}
+
+	// A* on the abstract graph
+	FGKHexSearchScratch& Search    = AbstractScratch;
+	FIntPoint            GoalAxial = Storage.AxialOf(Goal);
+
+	auto Push = [&](int32 Index, int32 Cost, int32 Parent) {
+		if (Search.IsVisited(Index) && Search.Cost[Index] <= Cost) {
+			return;
+		}
+		Search.Visit(Index, Cost, Parent);
+		Search.Open.HeapPush({Index, Cost, Cost + FGKHexPathfinder::Distance(Storage.AxialOf(Index), GoalAxial)});
+	};
+
+	Search.Prepare(Storage.GetIndexCount());
+	Search.Visit(Start, 0, INDEX_NONE);
+	Search.Open.HeapPush({Start, 0, 0});
+
+	bool bFound = false;
+	while (Search.Open.Num() > 0) {
+		FGKHexOpenNode Node;
+		Search.Open.HeapPop(Node, false);
+
+		if (Node.Cost != Search.Cost[Node.Index]) {
+			continue;
+		}
+
+		if (Node.Index == Goal) {
+			bFound = true;
+			break;
+		}
+
+		if (Node.Index == Start) {
+			for (int32 i = 0; i < StartCosts.Num(); i++) {
+				if (StartCosts[i] != MAX_int32) {
+					Push(StartChunk.Nodes[i], StartCosts[i], Start);
+				}
+			}
+		}
+
+		int32                      Slot  = Node.Index / GKHEX_CHUNK_AREA;
+		FGKHexAbstractChunk const& Chunk = Chunks[Slot];
+		int32                      Self  = Chunk.FindNode(Node.Index);
+
+		if (Self == INDEX_NONE) {
+			continue;
+		}
+
+		int32 Count = Chunk.Nodes.Num();
+		for (int32 j = 0; j < Count; j++) {
+			int32 Distance = Chunk.Distances[Self * Count + j];
+			if (j != Self && Distance != MAX_int32) {
+				Push(Chunk.Nodes[j], Node.Cost + Distance, Node.Index);
+			}
+		}
+
+		for (FGKHexAbstractEdge const& Edge: Chunk.Inter[Self]) {
+			Push(Edge.To, Node.Cost + Edge.Cost, Node.Index);
+		}
+
+		if (Slot == GoalSlot && GoalCosts[Self] != MAX_int32) {
+			Push(Goal, Node.Cost + GoalCosts[Self], Node.Index);
+		}
+	}
+
+	if (!bFound) {
+		return false;
+	}
+
+	// Refine the abstract path chunk by chunk
+	TArray<int32> Abstract;
+	TArray<int32> Segment;
+	Search.Reconstruct(Goal, Abstract);
+
+	OutPath.Add(Start);
+	for (int32 i = 1; i < Abstract.Num(); i++) {
+		int32 From = Abstract[i - 1];
+		int32 To   = Abstract[i];
+
+		if (From == To) {
+			continue;
+		}
+
+		// Inter edges are always between two adjacent tiles
+		if (From / GKHEX_CHUNK_AREA != To / GKHEX_CHUNK_AREA) {
+			if (Occupancy != nullptr && !Occupancy->IsFree(To, Owner)) {
+				OutPath.Reset();
+				return false;
+			}
+			OutPath.Add(To);
+			continue;
+		}
+
+		if (!FGKHexPathfinder::FindPath(Storage, Scratch, From, To, Segment, From / GKHEX_CHUNK_AREA, Occupancy, Owner)) {
+			OutPath.Reset();
+			return false;
+		}
+		OutPath.Append(Segment.GetData() + 1, Segment.Num() - 1);
+	}
+
+	return true;
+}
@@ -0,0 +1,158 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Grid/GKHexGridStorage.h"
+#include "Grid/GKHexOccupancy.h"
+
+struct FGKHexOpenNode
+{
+	int32 Index;
+	int32 Cost;     // Cost from the start
+	int32 Priority; // Cost + Heuristic
+
+	bool operator< (FGKHexOpenNode const& Other) const { return Priority < Other.Priority; }
+};
+
+/** Search buffers aligned with FGKHexGridStorage indices
+ *
+ * Buffers are stamped with a generation number so starting a new search
+ * does not require clearing them.
+ */
+struct GAMEKIT_API FGKHexSearchScratch
+{
+	TArray<int32>          Cost;
+	TArray<int32>          Parent;
+	TArray<int32>          Order; // Position of the node in the result of Reachable
+	TArray<uint32>         Stamp;
+	TArray<FGKHexOpenNode> Open;
+	uint32                 Generation = 0;
+
+	//! Start a new search over a storage of IndexCount slots
+	void Prepare(int32 IndexCount);
+
+	bool IsVisited(int32 Index) const { return Stamp[Index] == Generation; }
+
+	void Visit(int32 Index, int32 InCost, int32 InParent) {
+		Stamp[Index]  = Generation;
+		Cost[Index]   = InCost;
+		Parent[Index] = InParent;
+	}
+
+	//! Build the path ending at Index by walking back the parents
+	void Reconstruct(int32 Index, TArray<int32>& OutPath) const;
+};
+
+//! Cost of moving between two storage indices, negative when the move is not allowed
+using FGKHexCostFunction = TFunctionRef<int32(int32 From, int32 To)>;
+
+class GAMEKIT_API FGKHexPathfinder
+{
+public:
+	//! Hex distance between two axial coordinates
+	static int32 Distance(FIntPoint A, FIntPoint B) {
+		int32 DQ = A.X - B.X;
+		int32 DR = A.Y - B.Y;
+		return (FMath::Abs(DQ) + FMath::Abs(DR) + FMath::Abs(DQ + DR)) / 2;
+	}
+
+	/** A* from Start to Goal (storage indices), the path includes both ends
+	 *
+	 * When ChunkSlot is set the search does not leave that chunk.
+	 * When Occupancy is set, tiles held by someone else than Owner are avoided.
+	 */
+	static bool FindPath(FGKHexGridStorage const& Storage,
+	                     FGKHexSearchScratch&     Scratch,
+	                     int32                    Start,
+	                     int32                    Goal,
+	                     TArray<int32>&           OutPath,
+	                     int32                    ChunkSlot = INDEX_NONE,
+	                     FGKHexOccupancy const*   Occupancy = nullptr,
+	                     int32                    Owner     = GKHEX_NO_OCCUPANT);
+
+	/** Bounded Dijkstra collecting every tile reachable from Start within Budget
+	 *
+	 * Tiles are returned sorted by cost so a predecessor always comes before its successors.
+	 * Scratch.Cost, Scratch.Parent and Scratch.Order stay valid until the next search.
+	 */
+	static void Reachable(FGKHexGridStorage const& Storage,
+	                      FGKHexSearchScratch&     Scratch,
+	                      int32                    Start,
+	                      int32                    Budget,
+	                      FGKHexCostFunction       CostFn,
+	                      TArray<int32>&           OutTiles);
+
+	/** Dijkstra from Source restricted to a single chunk
+	 *
+	 * Results are left inside the Scratch buffers.
+	 * When bReverse is set, the computed costs are the costs of reaching Source
+	 */
+	static void ChunkDistances(FGKHexGridStorage const& Storage,
+	                           FGKHexSearchScratch&     Scratch,
+	                           int32                    Source,
+	                           int32                    ChunkSlot,
+	                           bool                     bReverse = false);
+};
+
+struct FGKHexAbstractEdge
+{
+	int32 To;   // Storage index of the destination entrance
+	int32 Cost;
+};
+
+//! Entrances of a chunk and the distances between them
+struct FGKHexAbstractChunk
+{
+	TArray<int32>                      Nodes;     // Storage index of the entrances
+	TArray<int32>                      Distances; // Nodes x Nodes, MAX_int32 if unreachable
+	TArray<TArray<FGKHexAbstractEdge>> Inter;     // Edges leaving the chunk for each node
+	bool                               bDirty = true;
+
+	int32 FindNode(int32 Index) const { return Nodes.Find(Index); }
+};
+
+/** Hierarchical path finding (HPA*) using the storage chunks as clusters
+ *
+ * Entrances are computed on the borders between chunks and connected
+ * inside each chunk using precomputed distances.
+ * Long paths are searched on the abstract graph and then refined
+ * chunk by chunk using a local A*.
+ *
+ * When tiles change, only the chunk and its direct neighbours are rebuilt.
+ */
+class GAMEKIT_API FGKHexHierarchy
+{
+public:
+	//! Flag a chunk (and its neighbours whose borders depend on it) for rebuild
+	void MarkDirty(FGKHexGridStorage const& Storage, FIntPoint ChunkCoord);
+
+	void MarkAllDirty();
+
+	//! Rebuild the dirty chunks, called automatically before each query
+	void Update(FGKHexGridStorage const& Storage);
+
+	/** Occupancy is only used when refining the path, the abstract graph
+	 * ignores units so a path can fail when occupied tiles block a chunk
+	 */
+	bool FindPath(FGKHexGridStorage const& Storage,
+	              FGKHexSearchScratch&     Scratch,
+	              int32                    Start,
+	              int32                    Goal,
+	              TArray<int32>&           OutPath,
+	              FGKHexOccupancy const*   Occupancy = nullptr,
+	              int32                    Owner     = GKHEX_NO_OCCUPANT);
+
+	int32 GetNodeCount() const;
+
+private:
+	void RebuildChunk(FGKHexGridStorage const& Storage, FGKHexSearchScratch& Scratch, int32 Slot);
+
+	//! Entrances between two chunks, computed identically from both sides
+	void GetTransitions(FGKHexGridStorage const& Storage, int32 SlotA, int32 SlotB, TArray<TPair<int32, int32>>& Out) const;
+
+	TArray<FGKHexAbstractChunk> Chunks; // Aligned with the storage chunks
+	FGKHexSearchScratch         AbstractScratch;
+	bool                        bDirty = true;
+};
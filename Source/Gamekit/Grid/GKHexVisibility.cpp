@@ -0,0 +1,113 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#include "Grid/GKHexVisibility.h"
+
+#include "Grid/GKHexGridUtilities.h"
+
+namespace {
+
+// Portion of the ring perimeter, in [0, 1]
+struct FGKHexShadow
+{
+	float Start;
+	float End;
+};
+
+using FGKHexShadows = TArray<FGKHexShadow, TInlineAllocator<32>>;
+
+constexpr float ShadowEpsilon = 1e-5f;
+
+bool IsInShadow(FGKHexShadows const& Shadows, float Value) {
+	for (FGKHexShadow const& Shadow: Shadows) {
+		if (Shadow.Start < Value && Value < Shadow.End) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//! Insert a shadow keeping the list sorted and merged
+void AddShadow(FGKHexShadows& Shadows, float Start, float End) {
+	int32 Index = 0;
+	while (Index < Shadows.Num() && Shadows[Index].Start < Start) {
+		Index += 1;
+	}
+	Shadows.Insert({Start, End}, Index);
+
+	for (int32 i = 0; i + 1 < Shadows.Num();) {
+		if (Shadows[i + 1].Start <= Shadows[i].End + ShadowEpsilon) {
+			Shadows[i].End = FMath::Max(Shadows[i].End, Shadows[i + 1].End);
+			Shadows.RemoveAt(i + 1, 1, false);
+		} else {
+			i += 1;
+		}
+	}
+}
+
+bool IsFullShadow(FGKHexShadows const& Shadows) {
+	return Shadows.Num() == 1 && Shadows[0].Start <= ShadowEpsilon && Shadows[0].End >= 1.f - ShadowEpsilon;
+}
+
+}
+
+void FGKHexVisibility::ComputeFieldOfView(FGKHexGridStorage const& Storage, FIntPoint Center, int32 Radius, TBitArray<>& Visible) {
+	Visible.Init(false, Storage.GetIndexCount());
+
+	int32 CenterIndex = Storage.TileIndexOf(Center);
+	if (CenterIndex != INDEX_NONE) {
+		Visible[CenterIndex] = true;
+	}
+
+	FGKHexShadows Shadows;
+	for (int32 Ring = 1; Ring <= Radius && !IsFullShadow(Shadows); Ring++) {
+		float Size = 1.f / float(6 * Ring);
+		int32 i    = 0;
+
+		for (FGKHexRingIterator It(Center, Ring); It; ++It, ++i) {
+			float Middle = float(i) * Size;
+
+			// the first tile of the ring straddles 0, check the wrapped parameter too
+			if (IsInShadow(Shadows, Middle) || (i == 0 && IsInShadow(Shadows, 1.f))) {
+				continue;
+			}
+
+			int32 Index = Storage.TileIndexOf(*It);
+			if (Index == INDEX_NONE) {
+				continue;
+			}
+
+			Visible[Index] = true;
+
+			if ((Storage.At(Index).Flags & GKHex_BlocksSight) == 0) {
+				continue;
+			}
+
+			float Start = Middle - Size * 0.5f;
+			float End   = Middle + Size * 0.5f;
+
+			if (Start < 0.f) {
+				AddShadow(Shadows, Start + 1.f, 1.f + ShadowEpsilon);
+				AddShadow(Shadows, -ShadowEpsilon, End);
+			} else {
+				AddShadow(Shadows, Start, End);
+			}
+		}
+	}
+}
+
+bool FGKHexVisibility::HasLineOfSight(FGKHexGridStorage const& Storage, FIntPoint A, FIntPoint B) {
+	for (FGKHexLineIterator It(A, B); It; ++It) {
+		FIntPoint Tile = *It;
+
+		// The end points never block
+		if (Tile == A || Tile == B) {
+			continue;
+		}
+
+		FGKHexTileData const* Data = Storage.Find(Tile);
+		if (Data != nullptr && (Data->Flags & GKHex_BlocksSight) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,30 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Grid/GKHexGridStorage.h"
+
+/** Line of sight queries over the tiles flagged with GKHex_BlocksSight
+ *
+ * Missing tiles are considered transparent.
+ * Blocking tiles are visible themselves but hide what is behind them.
+ */
+class GAMEKIT_API FGKHexVisibility
+{
+public:
+	/** Ring by ring shadow casting from Center up to Radius
+	 *
+	 * Each ring is parametrized by its perimeter, because rings are scaled copies of each other
+	 * a ray leaving the center keeps the same parameter on every ring.
+	 * Blocking tiles cast a shadow over their span of the perimeter, a tile is visible
+	 * if its center is not in shadow.
+	 *
+	 * Visible is resized to the storage index count and each visible tile has its bit set.
+	 */
+	static void ComputeFieldOfView(FGKHexGridStorage const& Storage, FIntPoint Center, int32 Radius, TBitArray<>& Visible);
+
+	//! Walk the line between A and B and stop at the first tile blocking sight
+	static bool HasLineOfSight(FGKHexGridStorage const& Storage, FIntPoint A, FIntPoint B);
+};
@@ -0,0 +1,83 @@
+// BSD 3-Clause License Copyright (c) 2019, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Dense 3D grid used as a cheap representation of a level during procedural generation
+ *
+ * Cells are stored row major, (r, c, d) is at c + r * Col + d * Col * Row
+ */
+template <typename T>
+struct T3DArray {
+    T3DArray(): Row(0), Col(0), Depth(0) {}
+
+    T3DArray(int row, int col, int depth = 1): Row(row), Col(col), Depth(depth) {
+        Data.Init(T(), Row * Col * Depth);
+    }
+
+    //! Resize and fill the array, keeps the allocation when it is big enough
+    void Init(int row, int col, int depth, T const &Value) {
+        Row   = row;
+        Col   = col;
+        Depth = depth;
+        Data.Reset(Row * Col * Depth);
+
+        for (int32 i = 0; i < Row * Col * Depth; i++) {
+            Data.Add(Value);
+        }
+    }
+
+    T &operator()(int r, int c, int d = 0) { return Data[IndexOf(r, c, d)]; }
+
+    T const &operator()(int r, int c, int d = 0) const { return Data[IndexOf(r, c, d)]; }
+
+    T &operator()(FIntVector v) { return Data[IndexOf(v.X, v.Y, v.Z)]; }
+
+    T &operator[](int32 Index) { return Data[Index]; }
+
+    T const &operator[](int32 Index) const { return Data[Index]; }
+
+    int32 IndexOf(int r, int c, int d = 0) const { return c + r * Col + d * (Col * Row); }
+
+    FIntVector CoordOf(int32 Index) const {
+        return FIntVector((Index / Col) % Row, Index % Col, Index / (Col * Row));
+    }
+
+    bool IsValid(FIntVector v) const {
+        return v.X >= 0 && v.X < Row && v.Y >= 0 && v.Y < Col && v.Z >= 0 && v.Z < Depth;
+    }
+
+    //! Offsets of the maze cells around v (2 cells away) that are inside the grid
+    TArray<FIntVector> GetNeighbours(FIntVector v) {
+        static const FIntVector Offsets[4] = {
+            FIntVector(-2, 0, 0), FIntVector(+2, 0, 0), FIntVector(0, -2, 0), FIntVector(0, +2, 0),
+        };
+
+        TArray<FIntVector> Result;
+        Result.Reserve(4);
+
+        for (int i = 0; i < 4; i++) {
+            if (IsValid(v + Offsets[i])) {
+                Result.Add(Offsets[i]);
+            }
+        }
+        return Result;
+    }
+
+    int32 Num() const { return Data.Num(); }
+
+    int GetRow() const { return Row; }
+
+    int GetCol() const { return Col; }
+
+    int GetDepth() const { return Depth; }
+
+    TArray<T> &GetData() { return Data; }
+
+    private:
+    int       Row;
+    int       Col;
+    int       Depth;
+    TArray<T> Data;
+};
@@ -0,0 +1,256 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#include "Procedural/GKChunkedLevelGeneration.h"
+
+#include "Blueprint/GKMazeGeneration.h"
+#include "Gamekit.h"
+
+#include "Async/Async.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "GameFramework/Actor.h"
+
+int32 FGKChunkedLevelGeneration::ChunkSeed(int32 Seed, FIntPoint Coord) {
+	return int32(HashCombine(GetTypeHash(Seed), GetTypeHash(Coord)));
+}
+
+int32 FGKChunkedLevelGeneration::BorderSeed(int32 Seed, FIntPoint A, FIntPoint B) {
+	if (B.X < A.X || (B.X == A.X && B.Y < A.Y)) {
+		Swap(A, B);
+	}
+	return int32(HashCombine(HashCombine(GetTypeHash(Seed), GetTypeHash(A)), GetTypeHash(B)));
+}
+
+void FGKChunkedLevelGeneration::Start(FIntPoint Min, FIntPoint Max, FIntPoint Focus, int32 Seed, FGKChunkGenerator Generator, int32 NumWorkers) {
+	Cancel();
+
+	State = MakeShared<FState, ESPMode::ThreadSafe>();
+	State->Seed      = Seed;
+	State->Generator = MoveTemp(Generator);
+	Dequeued         = 0;
+
+	for (int32 Y = Min.Y; Y <= Max.Y; Y++) {
+		for (int32 X = Min.X; X <= Max.X; X++) {
+			State->Order.Emplace(X, Y);
+		}
+	}
+
+	// Chunks close to the focus are generated first
+	State->Order.StableSort([Focus](FIntPoint const& A, FIntPoint const& B) {
+		return (A - Focus).SizeSquared() < (B - Focus).SizeSquared();
+	});
+
+	if (NumWorkers <= 0) {
+		NumWorkers = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1);
+	}
+	NumWorkers = FMath::Min(NumWorkers, State->Order.Num());
+
+	for (int32 i = 0; i < NumWorkers; i++) {
+		Async(EAsyncExecution::ThreadPool, [Shared = State]() { Work(Shared); });
+	}
+}
+
+void FGKChunkedLevelGeneration::Work(TSharedPtr<FState, ESPMode::ThreadSafe> State) {
+	while (!State->bCancelled) {
+		int32 Index = State->Next.Increment() - 1;
+
+		if (Index >= State->Order.Num()) {
+			return;
+		}
+
+		FGKGeneratedChunk Chunk;
+		Chunk.Coord = State->Order[Index];
+
+		FRandomStream Stream(ChunkSeed(State->Seed, Chunk.Coord));
+		State->Generator(Chunk.Coord, Stream, Chunk.Records);
+		State->Queue.Enqueue(MoveTemp(Chunk));
+	}
+}
+
+void FGKChunkedLevelGeneration::Cancel() {
+	if (State.IsValid()) {
+		State->bCancelled = true;
+	}
+}
+
+bool FGKChunkedLevelGeneration::Dequeue(FGKGeneratedChunk& Out) {
+	if (!State.IsValid() || !State->Queue.Dequeue(Out)) {
+		return false;
+	}
+
+	Dequeued += 1;
+	return true;
+}
+
+int32 FGKChunkedLevelGeneration::NumRemaining() const {
+	return State.IsValid() ? State->Order.Num() - Dequeued : 0;
+}
+
+UGKChunkedLevelComponent::UGKChunkedLevelComponent() {
+	PrimaryComponentTick.bCanEverTick          = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	ChunkSize         = 16;
+	ChunkCount        = FIntPoint(8, 8);
+	CellSize          = FVector2D(100.f, 100.f);
+	Seed              = 0;
+	MaxChunksPerFrame = 4;
+}
+
+void UGKChunkedLevelComponent::GenerateMazeChunk(FIntPoint Coord, FIntPoint Min, FIntPoint Max, int32 Size, int32 Seed, FVector2D CellSize, FRandomStream& Stream, TArray<FGKSpawnRecord>& Out) {
+	FIntPoint Base = Coord * Size;
+
+	auto Emit = [&](int32 X, int32 Y) {
+		Out.Add({FVector((Base.X + X) * CellSize.X, (Base.Y + Y) * CellSize.Y, 0.f), 0});
+	};
+
+	// Maze cells are at odd local coordinates so they line up across chunks
+	FGKMazeGrid   Grid(Size - 1, Size - 1);
+	TArray<int32> Stack;
+	UGKMazeGeneration::DepthFirstSearch(Grid, Stream, Stack, 0);
+
+	Out.Reserve(Out.Num() + Grid.Num() - Grid.NumOpen() + 2 * Size);
+
+	int32 Index = 0;
+	for (int32 X = 0; X < Grid.SizeX; X++) {
+		for (int32 Y = 0; Y < Grid.SizeY; Y++, Index++) {
+			if (!Grid.IsOpen(Index)) {
+				Emit(X + 1, Y + 1);
+			}
+		}
+	}
+
+	// West and south borders are shared with the neighbours, both sides draw the door from the same seed
+	int32 WestDoor  = INDEX_NONE;
+	int32 SouthDoor = INDEX_NONE;
+
+	if (Coord.X > Min.X) {
+		FRandomStream Border(FGKChunkedLevelGeneration::BorderSeed(Seed, Coord - FIntPoint(1, 0), Coord));
+		WestDoor = 1 + 2 * Border.RandRange(0, Size / 2 - 1);
+	}
+
+	if (Coord.Y > Min.Y) {
+		FRandomStream Border(FGKChunkedLevelGeneration::BorderSeed(Seed, Coord - FIntPoint(0, 1), Coord));
+		SouthDoor = 1 + 2 * Border.RandRange(0, Size / 2 - 1);
+	}
+
+	for (int32 Y = 0; Y < Size; Y++) {
+		if (Y != WestDoor) {
+			Emit(0, Y);
+		}
+	}
+
+	for (int32 X = 1; X < Size; X++) {
+		if (X != SouthDoor) {
+			Emit(X, 0);
+		}
+	}
+
+	// Close the level on the east and north sides
+	bool bEast  = Coord.X == Max.X;
+	bool bNorth = Coord.Y == Max.Y;
+
+	for (int32 i = 0; i < Size; i++) {
+		if (bEast) {
+			Emit(Size, i);
+		}
+		if (bNorth) {
+			Emit(i, Size);
+		}
+	}
+
+	if (bEast && bNorth) {
+		Emit(Size, Size);
+	}
+}
+
+void UGKChunkedLevelComponent::Generate(FVector Focus) {
+	Cancel();
+
+	for (UInstancedStaticMeshComponent* Component: Instances) {
+		if (Component != nullptr) {
+			Component->ClearInstances();
+		}
+	}
+
+	int32 Size = FMath::Max(ChunkSize + (ChunkSize & 1), 4);
+	if (Size != ChunkSize) {
+		UE_LOG(LogGamekit, Warning, TEXT("ChunkSize needs to be even and at least 4, using %d"), Size);
+	}
+
+	FIntPoint Min = FIntPoint(-ChunkCount.X / 2, -ChunkCount.Y / 2);
+	FIntPoint Max = Min + ChunkCount - FIntPoint(1, 1);
+
+	FVector   Local = Focus - GetOwner()->GetActorLocation();
+	FIntPoint FocusChunk(FMath::FloorToInt(Local.X / (CellSize.X * Size)), FMath::FloorToInt(Local.Y / (CellSize.Y * Size)));
+
+	FGKChunkGenerator ChunkGenerator = Generator;
+	if (!ChunkGenerator) {
+		int32     LevelSeed = Seed;
+		FVector2D Cell      = CellSize;
+
+		ChunkGenerator = [Min, Max, Size, LevelSeed, Cell](FIntPoint Coord, FRandomStream& Stream, TArray<FGKSpawnRecord>& Out) {
+			GenerateMazeChunk(Coord, Min, Max, Size, LevelSeed, Cell, Stream, Out);
+		};
+	}
+
+	Generation.Start(Min, Max, FocusChunk, Seed, MoveTemp(ChunkGenerator));
+	SetComponentTickEnabled(true);
+}
+
+void UGKChunkedLevelComponent::Cancel() {
+	Generation.Cancel();
+	SetComponentTickEnabled(false);
+}
+
+void UGKChunkedLevelComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	FGKGeneratedChunk Chunk;
+	for (int32 Count = 0; Count < MaxChunksPerFrame && Generation.Dequeue(Chunk); Count++) {
+		SpawnChunk(Chunk);
+		OnChunkSpawned.Broadcast(Chunk.Coord);
+	}
+
+	if (Generation.NumRemaining() == 0) {
+		SetComponentTickEnabled(false);
+		OnLevelGenerated.Broadcast();
+	}
+}
+
+void UGKChunkedLevelComponent::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	Generation.Cancel();
+	Super::EndPlay(EndPlayReason);
+}
+
+UInstancedStaticMeshComponent* UGKChunkedLevelComponent::GetInstances(int32 Class) {
+	if (Instances.Num() <= Class) {
+		Instances.SetNumZeroed(Class + 1);
+	}
+
+	UInstancedStaticMeshComponent*& Component = Instances[Class];
+	if (Component == nullptr) {
+		Component = NewObject<UInstancedStaticMeshComponent>(GetOwner());
+		Component->SetupAttachment(GetOwner()->GetRootComponent());
+		Component->SetStaticMesh(Meshes[Class]);
+		Component->RegisterComponent();
+	}
+	return Component;
+}
+
+void UGKChunkedLevelComponent::SpawnChunk(FGKGeneratedChunk const& Chunk) {
+	// One batch per mesh
+	for (int32 Class = 0; Class < Meshes.Num(); Class++) {
+		Transforms.Reset();
+
+		for (FGKSpawnRecord const& Record: Chunk.Records) {
+			if (Record.Class == Class) {
+				Transforms.Emplace(Record.Position);
+			}
+		}
+
+		if (Transforms.Num() > 0 && Meshes[Class] != nullptr) {
+			GetInstances(Class)->AddInstances(Transforms, false);
+		}
+	}
+}
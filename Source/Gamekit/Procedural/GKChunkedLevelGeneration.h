@@ -0,0 +1,160 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Containers/Queue.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Math/RandomStream.h"
+
+#include "GKChunkedLevelGeneration.generated.h"
+
+//! Something to spawn, Class indexes the palette of the consumer
+struct FGKSpawnRecord
+{
+	FVector Position;
+	int32   Class;
+};
+
+struct FGKGeneratedChunk
+{
+	FIntPoint              Coord;
+	TArray<FGKSpawnRecord> Records;
+};
+
+/** Generates the content of one chunk
+ *
+ * Called from worker threads so it cannot access UObjects.
+ * The stream is seeded from the level seed and the chunk coordinate,
+ * chunks sharing a border should use BorderSeed to agree on it.
+ */
+using FGKChunkGenerator = TFunction<void(FIntPoint Coord, FRandomStream& Stream, TArray<FGKSpawnRecord>& Out)>;
+
+/** Generate the chunks of a level on worker threads
+ *
+ * Chunks are dispatched in order of distance to a focus point (usually the player)
+ * and pushed to a queue as soon as they are done, so the game thread can
+ * start spawning them while the rest of the level is generating.
+ */
+class GAMEKIT_API FGKChunkedLevelGeneration
+{
+public:
+	~FGKChunkedLevelGeneration() { Cancel(); }
+
+	//! Generate the chunks inside [Min, Max], NumWorkers defaults to the number of worker threads
+	void Start(FIntPoint Min, FIntPoint Max, FIntPoint Focus, int32 Seed, FGKChunkGenerator Generator, int32 NumWorkers = 0);
+
+	//! Stop dispatching chunks, chunks being generated are still queued
+	void Cancel();
+
+	//! Pop a finished chunk, game thread only
+	bool Dequeue(FGKGeneratedChunk& Out);
+
+	//! Chunks that were not dequeued yet
+	int32 NumRemaining() const;
+
+	bool IsRunning() const { return State.IsValid() && NumRemaining() > 0 && !State->bCancelled; }
+
+	static int32 ChunkSeed(int32 Seed, FIntPoint Coord);
+
+	//! Seed shared by two adjacent chunks, independent of the order of A and B
+	static int32 BorderSeed(int32 Seed, FIntPoint A, FIntPoint B);
+
+private:
+	// Shared with the workers so it outlives a cancelled generation
+	struct FState
+	{
+		TArray<FIntPoint>                             Order;
+		FThreadSafeCounter                            Next;
+		FThreadSafeBool                               bCancelled;
+		TQueue<FGKGeneratedChunk, EQueueMode::Mpsc>   Queue;
+		FGKChunkGenerator                             Generator;
+		int32                                         Seed = 0;
+	};
+
+	static void Work(TSharedPtr<FState, ESPMode::ThreadSafe> State);
+
+	TSharedPtr<FState, ESPMode::ThreadSafe> State;
+	int32                                   Dequeued = 0;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FGKChunkSpawnedSignature, FIntPoint, Chunk);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FGKLevelGeneratedSignature);
+
+/*! UGKChunkedLevelComponent generates a maze level chunk by chunk in the background
+ *  and adds the finished chunks as instanced meshes a few at a time.
+ *
+ * Each chunk is a ChunkSize x ChunkSize maze, its west and south borders are walls
+ * with a single door whose position is derived from the seed of the border.
+ */
+UCLASS(Blueprintable, ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class GAMEKIT_API UGKChunkedLevelComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UGKChunkedLevelComponent();
+
+	//! Start generating the level, chunks close to Focus are generated first
+	UFUNCTION(BlueprintCallable, Category = "Procedural|Level")
+	void Generate(FVector Focus);
+
+	UFUNCTION(BlueprintCallable, Category = "Procedural|Level")
+	void Cancel();
+
+	UFUNCTION(BlueprintCallable, Category = "Procedural|Level")
+	bool IsGenerating() const { return Generation.IsRunning(); }
+
+	//! Replace the default maze generator, must be set before Generate
+	void SetGenerator(FGKChunkGenerator InGenerator) { Generator = MoveTemp(InGenerator); }
+
+	//! Walls of a maze chunk, Class 0 is a wall
+	static void GenerateMazeChunk(FIntPoint Coord, FIntPoint Min, FIntPoint Max, int32 Size, int32 Seed, FVector2D CellSize, FRandomStream& Stream, TArray<FGKSpawnRecord>& Out);
+
+	//! Number of cells along each side of a chunk, needs to be even
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural|Level")
+	int ChunkSize;
+
+	//! Number of chunks along X and Y, the level is centered on the owner
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural|Level")
+	FIntPoint ChunkCount;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural|Level")
+	FVector2D CellSize;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural|Level")
+	int Seed;
+
+	//! Mesh used for each class of spawn record
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural|Level")
+	TArray<class UStaticMesh*> Meshes;
+
+	//! Number of chunks added to the level each frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural|Level")
+	int MaxChunksPerFrame;
+
+	UPROPERTY(BlueprintAssignable, Category = "Procedural|Level")
+	FGKChunkSpawnedSignature OnChunkSpawned;
+
+	UPROPERTY(BlueprintAssignable, Category = "Procedural|Level")
+	FGKLevelGeneratedSignature OnLevelGenerated;
+
+protected:
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	class UInstancedStaticMeshComponent* GetInstances(int32 Class);
+
+	void SpawnChunk(FGKGeneratedChunk const& Chunk);
+
+	UPROPERTY(Transient)
+	TArray<class UInstancedStaticMeshComponent*> Instances;
+
+private:
+	FGKChunkedLevelGeneration Generation;
+	FGKChunkGenerator         Generator;
+	TArray<FTransform>        Transforms;
+};
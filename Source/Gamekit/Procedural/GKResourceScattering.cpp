@@ -0,0 +1,275 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#include "Procedural/GKResourceScattering.h"
+
+#include "Blueprint/GKMazeGeneration.h"
+#include "Experimental/GKGameResource.h"
+#include "Gamekit.h"
+
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "GameFramework/Actor.h"
+
+bool FGKScatterMask::IsExcluded(FVector2D Position) const {
+	if (Grid == nullptr) {
+		return false;
+	}
+
+	int32 X = FMath::FloorToInt((Position.X - Origin.X) / CellSize.X);
+	int32 Y = FMath::FloorToInt((Position.Y - Origin.Y) / CellSize.Y);
+
+	if (X < 0 || Y < 0 || X >= Grid->SizeX || Y >= Grid->SizeY) {
+		return false;
+	}
+	return !Grid->IsOpen(Grid->IndexOf(X, Y));
+}
+
+void FGKPoissonDiskSampler::Sample(FBox2D InBounds, TArray<FGKScatterType> const& Types, FGKScatterMask const& Mask, FRandomStream& Stream, TArray<FGKScatterPoint>& Points, int32 Attempts) {
+	Points.Reset();
+	Bounds = InBounds;
+
+	float Total = 0.f;
+	MinRadius   = MAX_flt;
+	MaxRadius   = 0.f;
+
+	int32 LastType = INDEX_NONE;
+
+	Cumulative.Reset(Types.Num());
+	for (int32 Type = 0; Type < Types.Num(); Type++) {
+		if (Types[Type].Weight > 0.f) {
+			MinRadius = FMath::Min(MinRadius, Types[Type].MinDistance);
+			MaxRadius = FMath::Max(MaxRadius, Types[Type].MinDistance);
+			Total += Types[Type].Weight;
+			LastType = Type;
+		}
+		Cumulative.Add(Total);
+	}
+
+	FVector2D Extent = Bounds.GetSize();
+	if (Total <= 0.f || MinRadius <= 0.f || Extent.X <= 0.f || Extent.Y <= 0.f) {
+		return;
+	}
+
+	// A cell is small enough to hold a single point
+	CellSize = MinRadius / FMath::Sqrt(2.f);
+	Size     = FIntPoint(FMath::CeilToInt(Extent.X / CellSize), FMath::CeilToInt(Extent.Y / CellSize));
+	Cells.Init(INDEX_NONE, Size.X * Size.Y);
+
+	// Points with a larger distance are also linked in a coarse grid so they are found
+	// without scanning MaxRadius around every candidate
+	LargeSize = FIntPoint(FMath::CeilToInt(Extent.X / MaxRadius), FMath::CeilToInt(Extent.Y / MaxRadius));
+	LargeCells.Init(INDEX_NONE, LargeSize.X * LargeSize.Y);
+	LargeNext.Reset();
+
+	Active.Reset();
+
+	auto DrawType = [&]() {
+		float Draw = Stream.FRand() * Total;
+		for (int32 Type = 0; Type < Cumulative.Num(); Type++) {
+			if (Draw < Cumulative[Type] && Types[Type].Weight > 0.f) {
+				return Type;
+			}
+		}
+		// FRand() * Total can round up to Total, never return a type without weight
+		return LastType;
+	};
+
+	// Growing from a single point cannot cross walls wider than twice the distance,
+	// keep throwing random seeds so regions cut off by the mask are filled as well
+	for (int32 Throw = 0; Throw < Attempts; Throw++) {
+		FGKScatterPoint Seed{
+			FVector2D(Stream.FRandRange(Bounds.Min.X, Bounds.Max.X), Stream.FRandRange(Bounds.Min.Y, Bounds.Max.Y)),
+			DrawType(),
+		};
+
+		if (Mask.IsExcluded(Seed.Position) || !IsFar(Seed.Position, Types[Seed.Type].MinDistance, Types, Points)) {
+			continue;
+		}
+
+		Insert(Seed, Types, Points);
+
+		while (Active.Num() > 0) {
+			int32           Slot   = Stream.RandRange(0, Active.Num() - 1);
+			FGKScatterPoint Parent = Points[Active[Slot]];
+			bool            bFound = false;
+
+			for (int32 i = 0; i < Attempts && !bFound; i++) {
+				int32 Type   = DrawType();
+				float Radius = FMath::Max(Types[Parent.Type].MinDistance, Types[Type].MinDistance);
+
+				// Uniform in the annulus [Radius, 2 * Radius] around the parent
+				float Angle    = Stream.FRand() * 2.f * PI;
+				float Distance = Radius * (1.f + Stream.FRand());
+
+				FVector2D Position = Parent.Position + FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * Distance;
+
+				if (Bounds.IsInside(Position) && !Mask.IsExcluded(Position) && IsFar(Position, Types[Type].MinDistance, Types, Points)) {
+					Insert({Position, Type}, Types, Points);
+					bFound = true;
+				}
+			}
+
+			if (!bFound) {
+				Active.RemoveAtSwap(Slot, 1, false);
+			}
+		}
+	}
+}
+
+bool FGKPoissonDiskSampler::IsFar(FVector2D Position, float Radius, TArray<FGKScatterType> const& Types, TArray<FGKScatterPoint> const& Points) const {
+	int32 X = FMath::Min(int32((Position.X - Bounds.Min.X) / CellSize), Size.X - 1);
+	int32 Y = FMath::Min(int32((Position.Y - Bounds.Min.Y) / CellSize), Size.Y - 1);
+
+	if (Cells[X * Size.Y + Y] != INDEX_NONE) {
+		return false;
+	}
+
+	auto IsTooClose = [&](int32 Index) {
+		FGKScatterPoint const& Other = Points[Index];
+		float                  Min   = FMath::Max(Radius, Types[Other.Type].MinDistance);
+		return FVector2D::DistSquared(Position, Other.Position) < Min * Min;
+	};
+
+	// Every point closer than Radius
+	int32 Reach = FMath::CeilToInt(Radius / CellSize);
+
+	for (int32 i = FMath::Max(X - Reach, 0); i <= FMath::Min(X + Reach, Size.X - 1); i++) {
+		for (int32 j = FMath::Max(Y - Reach, 0); j <= FMath::Min(Y + Reach, Size.Y - 1); j++) {
+			int32 Index = Cells[i * Size.Y + j];
+
+			if (Index != INDEX_NONE && IsTooClose(Index)) {
+				return false;
+			}
+		}
+	}
+
+	// Points further away can still be in conflict if their own distance is larger
+	if (Radius < MaxRadius) {
+		int32 LX = FMath::Min(int32((Position.X - Bounds.Min.X) / MaxRadius), LargeSize.X - 1);
+		int32 LY = FMath::Min(int32((Position.Y - Bounds.Min.Y) / MaxRadius), LargeSize.Y - 1);
+
+		for (int32 i = FMath::Max(LX - 1, 0); i <= FMath::Min(LX + 1, LargeSize.X - 1); i++) {
+			for (int32 j = FMath::Max(LY - 1, 0); j <= FMath::Min(LY + 1, LargeSize.Y - 1); j++) {
+				for (int32 Index = LargeCells[i * LargeSize.Y + j]; Index != INDEX_NONE; Index = LargeNext[Index]) {
+					if (Types[Points[Index].Type].MinDistance > Radius && IsTooClose(Index)) {
+						return false;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+void FGKPoissonDiskSampler::Insert(FGKScatterPoint const& Point, TArray<FGKScatterType> const& Types, TArray<FGKScatterPoint>& Points) {
+	int32 X = FMath::Min(int32((Point.Position.X - Bounds.Min.X) / CellSize), Size.X - 1);
+	int32 Y = FMath::Min(int32((Point.Position.Y - Bounds.Min.Y) / CellSize), Size.Y - 1);
+
+	int32 Index            = Points.Add(Point);
+	Cells[X * Size.Y + Y] = Index;
+	Active.Add(Index);
+
+	int32& Next = LargeNext.Add_GetRef(INDEX_NONE);
+
+	if (Types[Point.Type].MinDistance > MinRadius) {
+		int32 LX = FMath::Min(int32((Point.Position.X - Bounds.Min.X) / MaxRadius), LargeSize.X - 1);
+		int32 LY = FMath::Min(int32((Point.Position.Y - Bounds.Min.Y) / MaxRadius), LargeSize.Y - 1);
+
+		int32& Head = LargeCells[LX * LargeSize.Y + LY];
+		Next        = Head;
+		Head        = Index;
+	}
+}
+
+void UGKResourceScattering::Scatter(FBox2D Bounds, float Z, TArray<FGKScatterResource> const& Resources, FGKScatterMask const& Mask, FRandomStream& Stream, TArray<FGKScatteredResource>& Out) {
+	TArray<FGKScatterType> Types;
+	Types.Reserve(Resources.Num());
+
+	for (FGKScatterResource const& Resource: Resources) {
+		// Do not place resources without a class
+		Types.Add({Resource.MinDistance, Resource.Resource != nullptr ? Resource.Weight : 0.f});
+	}
+
+	FGKPoissonDiskSampler   Sampler;
+	TArray<FGKScatterPoint> Points;
+	Sampler.Sample(Bounds, Types, Mask, Stream, Points);
+
+	int32 First = Out.Num();
+	Out.AddDefaulted(Resources.Num());
+
+	for (int32 Type = 0; Type < Resources.Num(); Type++) {
+		Out[First + Type].Resource = Resources[Type].Resource;
+	}
+
+	for (FGKScatterPoint const& Point: Points) {
+		AGKGameResource const* Defaults = Resources[Point.Type].Resource.GetDefaultObject();
+
+		// Same conventions as the resource actor, a zero range keeps the default
+		float Scale = Defaults->RandomSize.IsZero() ? 1.f : Stream.FRandRange(Defaults->RandomSize.X, Defaults->RandomSize.Y);
+		float Yaw   = Stream.FRandRange(Defaults->RandomRotation.X, Defaults->RandomRotation.Y);
+
+		Out[First + Point.Type].Transforms.Emplace(FRotator(0.f, Yaw, 0.f), FVector(Point.Position, Z), FVector(Scale));
+	}
+}
+
+void UGKResourceScattering::ScatterResources(FVector Center, FVector2D Extent, TArray<FGKScatterResource> const& Resources, TArray<FGKScatteredResource>& Out, int Seed) {
+	FRandomStream Stream(Seed);
+	FVector2D     Center2D(Center.X, Center.Y);
+
+	Scatter(FBox2D(Center2D - Extent, Center2D + Extent), Center.Z, Resources, FGKScatterMask(), Stream, Out);
+}
+
+void UGKResourceScattering::ScatterResourcesInMaze(FVector Center, FVector2D Extent, int GridX, int GridY, TArray<FIntVector> const& Walls, TArray<FGKScatterResource> const& Resources, TArray<FGKScatteredResource>& Out, int Seed) {
+	FGKMazeGrid Grid;
+	FIntPoint   Min;
+
+	if (!Grid.FromWalls(GridX, GridY, Walls, Min)) {
+		return ScatterResources(Center, Extent, Resources, Out, Seed);
+	}
+
+	// Walls are centered on their position
+	FGKScatterMask Mask;
+	Mask.Grid     = &Grid;
+	Mask.CellSize = FVector2D(GridX, GridY);
+	Mask.Origin   = FVector2D(Center.X + (Min.X - 0.5f) * GridX, Center.Y + (Min.Y - 0.5f) * GridY);
+
+	FRandomStream Stream(Seed);
+	FVector2D     Center2D(Center.X, Center.Y);
+
+	Scatter(FBox2D(Center2D - Extent, Center2D + Extent), Center.Z, Resources, Mask, Stream, Out);
+}
+
+void UGKResourceScattering::AddResourceInstances(AActor* Owner, TArray<FGKScatteredResource> const& Scattered, TArray<UInstancedStaticMeshComponent*>& Components) {
+	if (Owner == nullptr) {
+		UE_LOG(LogGamekit, Warning, TEXT("AddResourceInstances needs an owner"));
+		return;
+	}
+
+	TArray<FTransform> Transforms;
+
+	for (FGKScatteredResource const& Resource: Scattered) {
+		if (Resource.Resource == nullptr || Resource.Transforms.Num() == 0) {
+			continue;
+		}
+
+		AGKGameResource const* Defaults = Resource.Resource.GetDefaultObject();
+		if (Defaults->ResourceMesh == nullptr || Defaults->ResourceMesh->GetStaticMesh() == nullptr) {
+			UE_LOG(LogGamekit, Warning, TEXT("%s has no mesh, skipping its instances"), *Resource.Resource->GetName());
+			continue;
+		}
+
+		// Instances are relative to the component
+		Transforms.Reset(Resource.Transforms.Num());
+		for (FTransform const& Transform: Resource.Transforms) {
+			Transforms.Add(Transform.GetRelativeTransform(Owner->GetActorTransform()));
+		}
+
+		UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(Owner);
+		Component->SetupAttachment(Owner->GetRootComponent());
+		Component->SetStaticMesh(Defaults->ResourceMesh->GetStaticMesh());
+		Component->RegisterComponent();
+		Component->AddInstances(Transforms, false);
+
+		Components.Add(Component);
+	}
+}
@@ -0,0 +1,131 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "Math/RandomStream.h"
+#include "Templates/SubclassOf.h"
+
+#include "GKResourceScattering.generated.h"
+
+struct FGKMazeGrid;
+
+// A kind of point to scatter
+struct FGKScatterType
+{
+	float MinDistance = 500.f;
+	float Weight      = 1.f;
+};
+
+struct FGKScatterPoint
+{
+	FVector2D Position;
+	int32     Type;
+};
+
+/** Area where nothing can be placed, the closed cells of a maze grid
+ *
+ * Points outside of the grid are not excluded.
+ */
+struct GAMEKIT_API FGKScatterMask
+{
+	FGKMazeGrid const* Grid = nullptr;
+
+	//! Corner of the cell (0, 0)
+	FVector2D Origin = FVector2D(0.f, 0.f);
+
+	FVector2D CellSize = FVector2D(100.f, 100.f);
+
+	bool IsExcluded(FVector2D Position) const;
+};
+
+/** Bridson's Poisson disk sampling with a different minimum distance per type
+ *
+ * Two points are at least max(MinDistance(A), MinDistance(B)) apart.
+ * The type of each new point is drawn according to the type weights.
+ * The sampler keeps its buffers so it can be reused without allocating.
+ */
+class GAMEKIT_API FGKPoissonDiskSampler
+{
+public:
+	//! Fill Bounds with points, Attempts is the number of candidates tried around each point
+	void Sample(FBox2D Bounds, TArray<FGKScatterType> const& Types, FGKScatterMask const& Mask, FRandomStream& Stream, TArray<FGKScatterPoint>& Points, int32 Attempts = 30);
+
+private:
+	bool IsFar(FVector2D Position, float Radius, TArray<FGKScatterType> const& Types, TArray<FGKScatterPoint> const& Points) const;
+
+	void Insert(FGKScatterPoint const& Point, TArray<FGKScatterType> const& Types, TArray<FGKScatterPoint>& Points);
+
+	FBox2D        Bounds;
+	float         MinRadius = 0.f;
+	float         MaxRadius = 0.f;
+	float         CellSize  = 1.f;
+	FIntPoint     Size;
+	TArray<int32> Cells;      // Index of the point inside each cell of the background grid
+	FIntPoint     LargeSize;
+	TArray<int32> LargeCells; // First point with a distance above MinRadius in each MaxRadius cell
+	TArray<int32> LargeNext;  // Next point in the same large cell
+	TArray<int32> Active;     // Points that can still have neighbours
+	TArray<float> Cumulative;
+};
+
+// A resource to scatter
+USTRUCT(BlueprintType)
+struct GAMEKIT_API FGKScatterResource
+{
+	GENERATED_BODY()
+
+	// Resource to place, its mesh, RandomSize and RandomRotation are used for the instances
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural|Resource")
+	TSubclassOf<class AGKGameResource> Resource;
+
+	// Minimum distance between this resource and any other resource
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural|Resource")
+	float MinDistance = 500.f;
+
+	// Relative probability of placing this resource, rare resources have a low weight
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural|Resource")
+	float Weight = 1.f;
+};
+
+// Instances of one resource
+USTRUCT(BlueprintType)
+struct GAMEKIT_API FGKScatteredResource
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Procedural|Resource")
+	TSubclassOf<class AGKGameResource> Resource;
+
+	// World transforms of the instances
+	UPROPERTY(BlueprintReadOnly, Category = "Procedural|Resource")
+	TArray<FTransform> Transforms;
+};
+
+/** Place resource nodes at map start
+ *
+ * Resources are returned as instanced transforms instead of actors
+ * so thousands of them can be placed at once.
+ */
+UCLASS()
+class GAMEKIT_API UGKResourceScattering : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	//! Scatter resources in the rectangle Center +/- Extent
+	UFUNCTION(BlueprintCallable, Category = "Procedural|Resource")
+	static void ScatterResources(FVector Center, FVector2D Extent, TArray<FGKScatterResource> const& Resources, TArray<FGKScatteredResource>& Out, int Seed = 0);
+
+	//! Scatter resources around the walls returned by UGKMazeGeneration
+	//! Walls are relative to Center, GridX and GridY are the values given to the maze generator
+	UFUNCTION(BlueprintCallable, Category = "Procedural|Resource")
+	static void ScatterResourcesInMaze(FVector Center, FVector2D Extent, int GridX, int GridY, TArray<FIntVector> const& Walls, TArray<FGKScatterResource> const& Resources, TArray<FGKScatteredResource>& Out, int Seed = 0);
+
+	//! Add the scattered resources to Owner as one instanced mesh per resource
+	UFUNCTION(BlueprintCallable, Category = "Procedural|Resource")
+	static void AddResourceInstances(class AActor* Owner, TArray<FGKScatteredResource> const& Scattered, TArray<class UInstancedStaticMeshComponent*>& Components);
+
+	static void Scatter(FBox2D Bounds, float Z, TArray<FGKScatterResource> const& Resources, FGKScatterMask const& Mask, FRandomStream& Stream, TArray<FGKScatteredResource>& Out);
+};
@@ -0,0 +1,199 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#include "Procedural/GKWaveFunctionCollapse.h"
+
+namespace {
+
+// -X, +X, -Y, +Y, -Z, +Z, the opposite of a direction is Direction ^ 1
+const FIntVector Directions[6] = {
+	FIntVector(-1, 0, 0),
+	FIntVector(+1, 0, 0),
+	FIntVector(0, -1, 0),
+	FIntVector(0, +1, 0),
+	FIntVector(0, 0, -1),
+	FIntVector(0, 0, +1),
+};
+
+} // namespace
+
+int32 FGKWaveFunctionCollapse::AddTile(float Weight) {
+	if (Weights.Num() >= GKWFC_MAX_TILES || Weight <= 0.f) {
+		return INDEX_NONE;
+	}
+
+	Compatible.AddZeroed(6);
+	WeightLogWeights.Add(Weight * FMath::Loge(Weight));
+	return Weights.Add(Weight);
+}
+
+void FGKWaveFunctionCollapse::Allow(int32 A, int32 B, int32 Direction) {
+	Compatible[A * 6 + Direction] |= uint64(1) << B;
+	Compatible[B * 6 + (Direction ^ 1)] |= uint64(1) << A;
+}
+
+void FGKWaveFunctionCollapse::AllowAllDirections(int32 A, int32 B) {
+	for (int32 Direction = 0; Direction < 6; Direction++) {
+		Allow(A, B, Direction);
+	}
+}
+
+void FGKWaveFunctionCollapse::Reset(int Row, int Col, int Depth, int32 Seed) {
+	int32  TileCount = Weights.Num();
+	uint64 All       = TileCount == GKWFC_MAX_TILES ? ~uint64(0) : (uint64(1) << TileCount) - 1;
+
+	Stream.Initialize(Seed);
+	Wave.Init(Row, Col, Depth, All);
+
+	Heap.Reset(Wave.Num());
+	Worklist.Reset(Wave.Num());
+	OnWorklist.Init(false, Wave.Num());
+
+	if (TileCount == 0) {
+		Status = EGKWFCStatus::Contradiction;
+		return;
+	}
+
+	Status = EGKWFCStatus::Running;
+
+	// Tiles that cannot have a neighbour in some direction are removed on the first step
+	for (int32 Cell = 0; Cell < Wave.Num(); Cell++) {
+		PushWorklist(Cell);
+		PushEntropy(Cell);
+	}
+}
+
+void FGKWaveFunctionCollapse::PushWorklist(int32 Cell) {
+	if (!OnWorklist[Cell]) {
+		OnWorklist[Cell] = true;
+		Worklist.Add(Cell);
+	}
+}
+
+void FGKWaveFunctionCollapse::PushEntropy(int32 Cell) {
+	uint64 Mask  = Wave[Cell];
+	int32  Count = FMath::CountBits(Mask);
+
+	if (Count <= 1) {
+		return;
+	}
+
+	float SumWeights    = 0.f;
+	float SumWeightLogs = 0.f;
+
+	for (; Mask != 0; Mask &= Mask - 1) {
+		int32 Tile = int32(FMath::CountTrailingZeros64(Mask));
+		SumWeights += Weights[Tile];
+		SumWeightLogs += WeightLogWeights[Tile];
+	}
+
+	// Shannon entropy, the noise breaks ties between cells with the same tiles
+	float Entropy = FMath::Loge(SumWeights) - SumWeightLogs / SumWeights + Stream.FRand() * 1e-4f;
+	Heap.HeapPush({Entropy, Cell, Count});
+}
+
+void FGKWaveFunctionCollapse::Collapse(int32 Cell) {
+	uint64 Mask = Wave[Cell];
+
+	float Total = 0.f;
+	for (uint64 Bits = Mask; Bits != 0; Bits &= Bits - 1) {
+		Total += Weights[FMath::CountTrailingZeros64(Bits)];
+	}
+
+	float  Draw   = Stream.FRand() * Total;
+	uint64 Chosen = 0;
+
+	for (uint64 Bits = Mask; Bits != 0; Bits &= Bits - 1) {
+		int32 Tile = int32(FMath::CountTrailingZeros64(Bits));
+		Chosen     = uint64(1) << Tile;
+		Draw -= Weights[Tile];
+
+		if (Draw < 0.f) {
+			break;
+		}
+	}
+
+	Wave[Cell] = Chosen;
+	PushWorklist(Cell);
+}
+
+bool FGKWaveFunctionCollapse::Propagate() {
+	while (Worklist.Num() > 0) {
+		int32 Cell = Worklist.Pop(false);
+		OnWorklist[Cell] = false;
+
+		FIntVector Coord = Wave.CoordOf(Cell);
+		uint64     Mask  = Wave[Cell];
+
+		for (int32 Direction = 0; Direction < 6; Direction++) {
+			FIntVector Next = Coord + Directions[Direction];
+
+			if (!Wave.IsValid(Next)) {
+				continue;
+			}
+
+			// Union of the tiles allowed next to any of the remaining tiles
+			uint64 Allowed = 0;
+			for (uint64 Bits = Mask; Bits != 0; Bits &= Bits - 1) {
+				Allowed |= Compatible[FMath::CountTrailingZeros64(Bits) * 6 + Direction];
+			}
+
+			int32   Neighbour = Wave.IndexOf(Next.X, Next.Y, Next.Z);
+			uint64& Possible  = Wave[Neighbour];
+
+			if ((Possible & Allowed) == Possible) {
+				continue;
+			}
+
+			Possible &= Allowed;
+			if (Possible == 0) {
+				return false;
+			}
+
+			PushEntropy(Neighbour);
+			PushWorklist(Neighbour);
+		}
+	}
+	return true;
+}
+
+EGKWFCStatus FGKWaveFunctionCollapse::Step(int32 Budget) {
+	if (Status != EGKWFCStatus::Running) {
+		return Status;
+	}
+
+	if (!Propagate()) {
+		Status = EGKWFCStatus::Contradiction;
+		return Status;
+	}
+
+	for (int32 i = 0; i < Budget; i++) {
+		// Skip the entries of cells that lost tiles since they were pushed
+		FEntropyEntry Entry;
+		do {
+			if (Heap.Num() == 0) {
+				Status = EGKWFCStatus::Done;
+				return Status;
+			}
+			Heap.HeapPop(Entry, false);
+		} while (FMath::CountBits(Wave[Entry.Cell]) != Entry.Count);
+
+		Collapse(Entry.Cell);
+
+		if (!Propagate()) {
+			Status = EGKWFCStatus::Contradiction;
+			return Status;
+		}
+	}
+
+	return Status;
+}
+
+void FGKWaveFunctionCollapse::GetResult(T3DArray<int32>& Out) const {
+	Out.Init(Wave.GetRow(), Wave.GetCol(), Wave.GetDepth(), INDEX_NONE);
+
+	for (int32 Cell = 0; Cell < Wave.Num(); Cell++) {
+		if (FMath::CountBits(Wave[Cell]) == 1) {
+			Out[Cell] = int32(FMath::CountTrailingZeros64(Wave[Cell]));
+		}
+	}
+}
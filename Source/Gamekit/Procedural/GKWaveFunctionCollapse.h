@@ -0,0 +1,97 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+
+#include "Procedural/GK3DArray.h"
+
+// Maximum number of tiles, the possible tiles of a cell are a 64 bits mask
+#define GKWFC_MAX_TILES 64
+
+enum class EGKWFCStatus : uint8
+{
+	Running,
+	Done,
+	Contradiction,
+};
+
+/** Wave function collapse, simple tiled model over a T3DArray
+ *
+ * Tiles are registered with a weight and the tiles allowed next to them
+ * in each of the 6 directions (-X, +X, -Y, +Y, -Z, +Z), X is the row, Y the column.
+ * Generation can be run incrementally with a budget of collapsed cells per call.
+ *
+ * \code
+ * FGKWaveFunctionCollapse Wfc;
+ * int32 Floor = Wfc.AddTile(4.f);
+ * int32 Wall  = Wfc.AddTile(1.f);
+ * Wfc.AllowAllDirections(Floor, Wall);
+ * Wfc.AllowAllDirections(Floor, Floor);
+ *
+ * Wfc.Reset(32, 32, 1, Seed);
+ * while (Wfc.Step(64) == EGKWFCStatus::Running) {}
+ * \endcode
+ */
+class GAMEKIT_API FGKWaveFunctionCollapse
+{
+public:
+	//! Register a tile, returns its index or INDEX_NONE if there are too many tiles
+	int32 AddTile(float Weight);
+
+	//! Allow B to be in Direction of A (and A in the opposite direction of B)
+	void Allow(int32 A, int32 B, int32 Direction);
+
+	void AllowAllDirections(int32 A, int32 B);
+
+	//! Start a new generation, keeps the buffers of the previous one
+	void Reset(int Row, int Col, int Depth, int32 Seed);
+
+	/** Collapse up to Budget cells, propagating the constraints after each one
+	 *
+	 * Returns Running until every cell holds a single tile, Contradiction if a cell
+	 * ran out of possible tiles (Reset with another seed to try again).
+	 */
+	EGKWFCStatus Step(int32 Budget);
+
+	EGKWFCStatus GetStatus() const { return Status; }
+
+	//! Tile of each cell, INDEX_NONE when the cell is not collapsed
+	void GetResult(T3DArray<int32>& Out) const;
+
+	//! Possible tiles of each cell
+	T3DArray<uint64> const& GetWave() const { return Wave; }
+
+	int32 NumTiles() const { return Weights.Num(); }
+
+private:
+	struct FEntropyEntry
+	{
+		float Entropy;
+		int32 Cell;
+		int32 Count; // Number of possible tiles when pushed, the entry is stale if it changed
+
+		bool operator<(FEntropyEntry const& Other) const { return Entropy < Other.Entropy; }
+	};
+
+	void PushEntropy(int32 Cell);
+
+	//! Choose a tile for the cell weighted by the tile weights
+	void Collapse(int32 Cell);
+
+	//! Remove the tiles that are not compatible with their neighbours anymore
+	bool Propagate();
+
+	void PushWorklist(int32 Cell);
+
+	TArray<float>                        Weights;
+	TArray<float>                        WeightLogWeights;
+	TArray<uint64>                       Compatible; // Tiles allowed in each direction, Tile * 6 + Direction
+	T3DArray<uint64>                     Wave;
+	TArray<FEntropyEntry>                Heap;
+	TArray<int32>                        Worklist;   // Cells whose neighbours need to be updated
+	TBitArray<>                          OnWorklist;
+	FRandomStream                        Stream;
+	EGKWFCStatus                         Status = EGKWFCStatus::Done;
+};
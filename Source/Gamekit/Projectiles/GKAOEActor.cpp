@@ -3,25 +3,56 @@
 
 #include "Gamekit/Projectiles/GKAOEActor.h"
 
+#include "Abilities/GKAbilityStatic.h"
+#include "Projectiles/GKAOEManager.h"
+
 // Sets default values
 AGKAOEActor::AGKAOEActor()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// Pulses are driven by UGKAOEManagerSubsystem, Blueprints can still enable the tick
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	bReplicates = true;
+
+	Radius = 300.f;
+	HalfHeight = 200.f;
+	Period = 1.f;
+	Duration = 5.f;
+	PulseOnStart = true;
+	AffectInstigator = false;
+}
+
+void AGKAOEActor::InitializeFromAbilityData(FGKAbilityStatic const& AbilityData) {
+	if (AbilityData.AreaOfEffect > 0.f) {
+		Radius = AbilityData.AreaOfEffect;
+	}
 
+	if (AbilityData.Duration > 0.f) {
+		Duration = AbilityData.Duration;
+	}
 }
 
 // Called when the game starts or when spawned
 void AGKAOEActor::BeginPlay()
 {
 	Super::BeginPlay();
-	
-}
 
-// Called every frame
-void AGKAOEActor::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
+	if (!HasAuthority()) {
+		return;
+	}
+
+	if (Duration > 0.f) {
+		SetLifeSpan(Duration);
+	}
 
+	GetWorld()->GetSubsystem<UGKAOEManagerSubsystem>()->AddAOE(this);
 }
 
+void AGKAOEActor::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (UGKAOEManagerSubsystem* Manager = GetWorld()->GetSubsystem<UGKAOEManagerSubsystem>()) {
+		Manager->RemoveAOE(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
@@ -8,6 +8,12 @@
 
 #include "GKAOEActor.generated.h"
 
+struct FGKAbilityStatic;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FGKAOEPulseDelegate, const TArray<AActor*>&, Targets);
+
+//! Apply its gameplay effects to the units inside its radius every Period seconds
+//! the pulses of all the AOEs are resolved together by UGKAOEManagerSubsystem on the server
 UCLASS()
 class GAMEKIT_API AGKAOEActor : public AGKAbilityEffectActor
 {
@@ -17,12 +23,39 @@ public:
 	// Sets default values for this actor's properties
 	AGKAOEActor();
 
+	//! Radius from FGKAbilityStatic::AreaOfEffect, duration from FGKAbilityStatic::Duration
+	void InitializeFromAbilityData(FGKAbilityStatic const& AbilityData);
+
+	//! Horizontal radius of the area
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ability|Effect", Meta = (ExposeOnSpawn = true));
+	float Radius;
+
+	//! Units further than this above or below the actor are not affected
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ability|Effect");
+	float HalfHeight;
+
+	//! Time between two applications of the effects, 0 applies them once
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ability|Effect", Meta = (ExposeOnSpawn = true));
+	float Period;
+
+	//! The actor is destroyed after Duration seconds, 0 keeps it until destroyed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ability|Effect", Meta = (ExposeOnSpawn = true));
+	float Duration;
+
+	//! Apply the effects as soon as the actor is spawned instead of after the first period
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ability|Effect");
+	bool PulseOnStart;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ability|Effect");
+	bool AffectInstigator;
+
+	//! Called on the server each time the effects are applied, with the units inside the area
+	UPROPERTY(BlueprintAssignable, Category = "Ability|Effect")
+	FGKAOEPulseDelegate OnPulse;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 };
@@ -0,0 +1,237 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#include "Projectiles/GKAOEManager.h"
+
+#include "Gamekit.h"
+#include "Projectiles/GKAOEActor.h"
+
+#include "Abilities/GameplayAbilityTargetTypes.h"
+#include "Engine/World.h"
+
+// FGKUnitGrid
+// -----------
+
+void FGKUnitGrid::Build(TArray<AActor*> const& Actors, float InCellSize) {
+	Units.Reset(Actors.Num());
+	MaxRadius = 0.f;
+
+	FBox2D Bounds(ForceInit);
+
+	for (AActor* Actor: Actors) {
+		if (!IsValid(Actor)) {
+			continue;
+		}
+
+		FUnit Unit;
+		Unit.Actor    = Actor;
+		Unit.Location = Actor->GetActorLocation();
+		Actor->GetSimpleCollisionCylinder(Unit.Radius, Unit.HalfHeight);
+
+		Bounds += FVector2D(Unit.Location);
+		MaxRadius = FMath::Max(MaxRadius, Unit.Radius);
+		Units.Add(Unit);
+	}
+
+	if (Units.Num() == 0) {
+		Size = FIntPoint(0, 0);
+		return;
+	}
+
+	// Bound the number of cells, units spread over a huge map end up in larger cells
+	static const int32 MaxCells = 128;
+
+	FVector2D Extent = Bounds.Max - Bounds.Min;
+	CellSize         = FMath::Max3(InCellSize, 1.f, FMath::Max(Extent.X, Extent.Y) / float(MaxCells - 1));
+	Origin           = Bounds.Min;
+	Size             = FIntPoint(FMath::FloorToInt(Extent.X / CellSize) + 1, FMath::FloorToInt(Extent.Y / CellSize) + 1);
+
+	// Counting sort of the units by cell
+	int32 CellCount = Size.X * Size.Y;
+	CellStart.Reset();
+	CellStart.SetNumZeroed(CellCount + 1);
+	UnitCell.SetNumUninitialized(Units.Num());
+
+	for (int32 i = 0; i < Units.Num(); i++) {
+		FIntPoint Cell = CellOf(Units[i].Location);
+		UnitCell[i]    = Cell.Y * Size.X + Cell.X;
+		CellStart[UnitCell[i] + 1] += 1;
+	}
+
+	for (int32 i = 0; i < CellCount; i++) {
+		CellStart[i + 1] += CellStart[i];
+	}
+
+	Cursor = CellStart;
+	Scratch.SetNumUninitialized(Units.Num());
+
+	for (int32 i = 0; i < Units.Num(); i++) {
+		Scratch[Cursor[UnitCell[i]]++] = Units[i];
+	}
+
+	Swap(Units, Scratch);
+}
+
+FIntPoint FGKUnitGrid::CellOf(FVector const& Location) const {
+	return FIntPoint(
+		FMath::Clamp(FMath::FloorToInt((Location.X - Origin.X) / CellSize), 0, Size.X - 1),
+		FMath::Clamp(FMath::FloorToInt((Location.Y - Origin.Y) / CellSize), 0, Size.Y - 1)
+	);
+}
+
+void FGKUnitGrid::Query(FVector Center, float Radius, float HalfHeight, TArray<AActor*>& Out) const {
+	if (Size.X == 0) {
+		return;
+	}
+
+	float     Reach = Radius + MaxRadius;
+	FIntPoint Min   = CellOf(Center - FVector(Reach, Reach, 0.f));
+	FIntPoint Max   = CellOf(Center + FVector(Reach, Reach, 0.f));
+
+	for (int32 Y = Min.Y; Y <= Max.Y; Y++) {
+		for (int32 X = Min.X; X <= Max.X; X++) {
+			int32 Cell = Y * Size.X + X;
+
+			for (int32 i = CellStart[Cell]; i < CellStart[Cell + 1]; i++) {
+				FUnit const& Unit = Units[i];
+
+				float DX    = Unit.Location.X - Center.X;
+				float DY    = Unit.Location.Y - Center.Y;
+				float Range = Radius + Unit.Radius;
+
+				if (DX * DX + DY * DY <= Range * Range && FMath::Abs(Unit.Location.Z - Center.Z) <= HalfHeight + Unit.HalfHeight) {
+					Out.Add(Unit.Actor);
+				}
+			}
+		}
+	}
+}
+
+// UGKAOEManagerSubsystem
+// ----------------------
+
+void UGKAOEManagerSubsystem::AddAOE(AGKAOEActor* AOE) {
+	if (AOE == nullptr || AOEs.Contains(AOE)) {
+		return;
+	}
+
+	float Now = GetWorld()->GetTimeSeconds();
+
+	AOEs.Add(AOE);
+	NextPulse.Add(AOE->PulseOnStart ? Now : Now + AOE->Period);
+}
+
+void UGKAOEManagerSubsystem::RemoveAOE(AGKAOEActor* AOE) {
+	int32 Index = AOEs.Find(AOE);
+
+	if (Index != INDEX_NONE) {
+		AOEs.RemoveAtSwap(Index, 1, false);
+		NextPulse.RemoveAtSwap(Index, 1, false);
+	}
+}
+
+void UGKAOEManagerSubsystem::RegisterUnit(AActor* Unit) {
+	if (Unit != nullptr) {
+		Units.AddUnique(Unit);
+	}
+}
+
+void UGKAOEManagerSubsystem::UnregisterUnit(AActor* Unit) { Units.RemoveSwap(Unit, false); }
+
+void UGKAOEManagerSubsystem::Deinitialize() {
+	AOEs.Reset();
+	NextPulse.Reset();
+	Units.Reset();
+	Super::Deinitialize();
+}
+
+bool UGKAOEManagerSubsystem::IsTickable() const { return !IsTemplate() && AOEs.Num() > 0; }
+
+TStatId UGKAOEManagerSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGKAOEManagerSubsystem, STATGROUP_Tickables);
+}
+
+namespace {
+
+// Units reached by one effect spec during a pass
+struct FGKEffectTargets
+{
+	FGameplayEffectSpecHandle Spec;
+	TSet<AActor*>             Targets;
+};
+
+} // namespace
+
+void UGKAOEManagerSubsystem::Tick(float DeltaTime) {
+	UWorld* World = GetWorld();
+	if (World == nullptr) {
+		return;
+	}
+
+	float Now = World->GetTimeSeconds();
+
+	TArray<AGKAOEActor*> Due;
+
+	for (int32 i = AOEs.Num() - 1; i >= 0; i--) {
+		AGKAOEActor* AOE = AOEs[i];
+
+		if (!IsValid(AOE)) {
+			AOEs.RemoveAtSwap(i, 1, false);
+			NextPulse.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		if (NextPulse[i] > Now) {
+			continue;
+		}
+
+		Due.Add(AOE);
+
+		// Keep the cadence unless we fell behind, no period means a single pulse
+		NextPulse[i] = AOE->Period > 0.f ? FMath::Max(NextPulse[i] + AOE->Period, Now) : MAX_flt;
+	}
+
+	if (Due.Num() == 0) {
+		return;
+	}
+
+	// One index for all the AOEs of this frame
+	Grid.Build(Units, CellSize);
+
+	TMap<FGameplayEffectSpec const*, FGKEffectTargets> Effects;
+	TArray<AActor*>                                    Targets;
+
+	for (AGKAOEActor* AOE: Due) {
+		Targets.Reset();
+		Grid.Query(AOE->GetActorLocation(), AOE->Radius, AOE->HalfHeight, Targets);
+
+		if (!AOE->AffectInstigator) {
+			Targets.RemoveSwap(AOE->GetInstigator(), false);
+		}
+
+		for (FGameplayEffectSpecHandle const& Spec: AOE->GameplayEffects.TargetGameplayEffectSpecs) {
+			if (!Spec.IsValid() || Targets.Num() == 0) {
+				continue;
+			}
+
+			// AOEs sharing a spec (e.g. spawned by the same cast) only apply it once per unit
+			FGKEffectTargets& Effect = Effects.FindOrAdd(Spec.Data.Get());
+			Effect.Spec              = Spec;
+			Effect.Targets.Append(Targets);
+		}
+
+		AOE->OnPulse.Broadcast(Targets);
+	}
+
+	for (TPair<FGameplayEffectSpec const*, FGKEffectTargets>& Effect: Effects) {
+		FGameplayAbilityTargetData_ActorArray* Data = new FGameplayAbilityTargetData_ActorArray();
+		Data->TargetActorArray.Reserve(Effect.Value.Targets.Num());
+
+		for (AActor* Target: Effect.Value.Targets) {
+			Data->TargetActorArray.Add(Target);
+		}
+
+		// The handle owns the data
+		FGameplayAbilityTargetDataHandle Handle(Data);
+		Data->ApplyGameplayEffectSpec(*Effect.Value.Spec.Data.Get());
+	}
+}
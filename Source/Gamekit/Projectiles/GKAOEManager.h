@@ -0,0 +1,103 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+
+#include "GKAOEManager.generated.h"
+
+class AGKAOEActor;
+
+/** Uniform grid over the units, rebuilt before each query pass
+ *
+ * Units are sorted by cell so a cell is a contiguous range of Units.
+ */
+struct GAMEKIT_API FGKUnitGrid
+{
+	struct FUnit
+	{
+		AActor* Actor;
+		FVector Location;
+		float   Radius;
+		float   HalfHeight;
+	};
+
+	//! Sort the units in cells of CellSize, the grid is coarsened when the units are too spread out
+	void Build(TArray<AActor*> const& Actors, float CellSize);
+
+	//! Units whose collision cylinder intersects the cylinder Center, Radius, HalfHeight
+	void Query(FVector Center, float Radius, float HalfHeight, TArray<AActor*>& Out) const;
+
+	int32 Num() const { return Units.Num(); }
+
+private:
+	FIntPoint CellOf(FVector const& Location) const;
+
+	FVector2D     Origin;
+	float         CellSize    = 1.f;
+	FIntPoint     Size        = FIntPoint(0, 0);
+	float         MaxRadius   = 0.f;
+	TArray<FUnit> Units;
+	TArray<int32> CellStart; // Units of cell i are in [CellStart[i], CellStart[i + 1])
+	TArray<int32> Cursor;
+	TArray<int32> UnitCell;
+	TArray<FUnit> Scratch;
+};
+
+/** Apply the effects of the area of effect actors periodically
+ *
+ * The AOEs that are due in a frame are resolved together, the unit grid is built once
+ * and queried by every AOE, then the effects are applied once per effect spec
+ * to every unit it reached so overlapping AOEs of the same cast do not stack.
+ *
+ * Server only.
+ */
+UCLASS()
+class GAMEKIT_API UGKAOEManagerSubsystem
+	: public UWorldSubsystem
+	, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	void AddAOE(AGKAOEActor* AOE);
+
+	void RemoveAOE(AGKAOEActor* AOE);
+
+	//! Units that can be affected by the AOEs
+	void RegisterUnit(AActor* Unit);
+
+	void UnregisterUnit(AActor* Unit);
+
+	UFUNCTION(BlueprintPure, Category = "Ability|Effect")
+	int NumAOE() const { return AOEs.Num(); }
+
+	//! Size of the cells of the unit grid, about the radius of the common AOEs
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ability|Effect")
+	float CellSize = 400.f;
+
+	void Deinitialize() override;
+
+	// FTickableGameObject
+	void Tick(float DeltaTime) override;
+
+	bool IsTickable() const override;
+
+	TStatId GetStatId() const override;
+
+	UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	UPROPERTY()
+	TArray<AGKAOEActor*> AOEs;
+
+	//! World time of the next pulse of each AOE
+	TArray<float> NextPulse;
+
+	UPROPERTY()
+	TArray<AActor*> Units;
+
+	FGKUnitGrid Grid;
+};
@@ -3,7 +3,12 @@
 
 #include "Gamekit/Projectiles/GKProjectile.h"
 
+#include "Projectiles/GKProjectileManager.h"
+#include "Projectiles/GKProjectilePool.h"
+
 #include "GameFramework/ProjectileMovementComponent.h"
+#include "Engine/NetSerialization.h"
+#include "Net/UnrealNetwork.h"
 
 // Sets default values
 AGKProjectile::AGKProjectile()
@@ -17,6 +22,9 @@ AGKProjectile::AGKProjectile()
 
 	bReplicates = true;
 
+	// Nothing changes between activations, the server flushes the dormancy when SpawnInfo changes
+	NetDormancy = DORM_DormantAll;
+
 	// Sane defaults so people experimenting will get something that works
 	Range = 1000;
 	Behavior = EGK_ProjectileBehavior::Directional;
@@ -25,15 +33,34 @@ AGKProjectile::AGKProjectile()
 // Called when the game starts or when spawned
 void AGKProjectile::BeginPlay()
 {
-	PreviousLoc = GetActorLocation();
-	DistanceTravelled = 0.f;
+	// The initial replication is done before BeginPlay, clients only start projectiles
+	// that are flying on the server; pooled ones can become relevant at any time
+	bool bActivate = HasAuthority() ? ActivateOnBeginPlay : SpawnInfo.Active;
 
-	// TODO: can this be guaranteed ?
-	// Replication should be done now; initialize movement
-	InitProjectileMovement();
-	ProjectileMovementComponent->InitializeComponent();
+	if (bActivate) {
+		if (!HasAuthority()) {
+			SetActorLocationAndRotation(SpawnInfo.Location, Direction.Rotation(), false, nullptr, ETeleportType::ResetPhysics);
+		}
+		ActivateProjectile();
+	}
 
 	Super::BeginPlay();
+
+	// Tick functions are enabled when registered by BeginPlay
+	if (!bActivate) {
+		DeactivateProjectile();
+	} else if (Batched) {
+		SetActorTickEnabled(false);
+		ProjectileMovementComponent->SetComponentTickEnabled(false);
+	}
+}
+
+void AGKProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (BatchIndex != INDEX_NONE) {
+		GetWorld()->GetSubsystem<UGKProjectileManagerSubsystem>()->Remove(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -41,7 +68,10 @@ void AGKProjectile::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	if (!ProjectileMovementComponent->bIsHomingProjectile){
+	if (ProjectileMovementComponent->bIsHomingProjectile) {
+		CheckHomingDivergence();
+	}
+	else {
 		auto CurrentLoc = GetActorLocation();
 		auto Distance = FVector::Dist(CurrentLoc, PreviousLoc);
 		
@@ -51,18 +81,267 @@ void AGKProjectile::Tick(float DeltaTime)
 		}
 
 		if (DistanceTravelled >= Range) {
-			Destroy();
+			Release();
 		}
 	}
 }
 
 void AGKProjectile::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-	DOREPLIFETIME(AGKProjectile, Speed);
-	DOREPLIFETIME(AGKProjectile, Direction);
-	DOREPLIFETIME(AGKProjectile, Target);
-	DOREPLIFETIME(AGKProjectile, Behavior);
-	DOREPLIFETIME(AGKProjectile, Range);
+	DOREPLIFETIME(AGKProjectile, SpawnInfo);
+}
+
+void AGKProjectile::ActivateProjectile() {
+	if (HasAuthority()) {
+		SpawnInfo.Location   = GetActorLocation();
+		SpawnInfo.Direction  = Direction;
+		SpawnInfo.Speed      = Speed;
+		SpawnInfo.Range      = Range;
+		SpawnInfo.Target     = Target;
+		SpawnInfo.Behavior   = Behavior;
+		SpawnInfo.Activation += 1;
+		SpawnInfo.Active      = true;
+		SpawnInfo.Quantize();
+
+		// Simulate with the values the clients receive so both follow the same path
+		Direction = SpawnInfo.Direction;
+		Speed     = SpawnInfo.Speed;
+		Range     = SpawnInfo.Range;
+		SetActorLocationAndRotation(SpawnInfo.Location, Direction.Rotation(), false, nullptr, ETeleportType::ResetPhysics);
+
+		RecordHomingTarget();
+		FlushNetDormancy();
+	}
+
+	Activation += 1;
+
+	PreviousLoc = GetActorLocation();
+	DistanceTravelled = 0.f;
+	Active = true;
+
+	SetActorHiddenInGame(false);
+
+	// The movement might have stopped on impact during the previous activation
+	auto Movement = ProjectileMovementComponent;
+	if (Movement->HasBeenInitialized()) {
+		Movement->UninitializeComponent();
+	}
+
+	// The manager moves the actor and sweeps for collisions
+	if (Batched) {
+		SetActorEnableCollision(false);
+		SetActorTickEnabled(false);
+		Movement->SetComponentTickEnabled(false);
+
+		GetWorld()->GetSubsystem<UGKProjectileManagerSubsystem>()->Add(this);
+		return;
+	}
+
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+
+	InitProjectileMovement();
+	Movement->SetUpdatedComponent(GetRootComponent());
+	Movement->Velocity = CastChecked<UProjectileMovementComponent>(Movement->GetArchetype())->Velocity;
+	Movement->InitializeComponent();
+	Movement->SetComponentTickEnabled(true);
+}
+
+void AGKProjectile::DeactivateProjectile() {
+	Active = false;
+
+	// Replicate the hidden state
+	if (HasAuthority()) {
+		SpawnInfo.Active = false;
+		FlushNetDormancy();
+	}
+
+	if (BatchIndex != INDEX_NONE) {
+		GetWorld()->GetSubsystem<UGKProjectileManagerSubsystem>()->Remove(this);
+	}
+
+	ProjectileMovementComponent->StopMovementImmediately();
+	ProjectileMovementComponent->SetComponentTickEnabled(false);
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+}
+
+void AGKProjectile::Release() {
+	if (!Active) {
+		return;
+	}
+
+	if (!HasAuthority()) {
+		DeactivateProjectile();
+		return;
+	}
+
+	UGKProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UGKProjectilePoolSubsystem>();
+	if (Pool == nullptr) {
+		Destroy();
+		return;
+	}
+
+	Pool->Release(this);
+}
+
+void AGKProjectile::NotifyBatchedHit(FHitResult const& Hit) {
+	OnProjectileHit.Broadcast(Hit);
+	Release();
+}
+
+void AGKProjectile::OnRep_SpawnInfo() {
+	Direction = SpawnInfo.Direction;
+	Speed     = SpawnInfo.Speed;
+	Range     = SpawnInfo.Range;
+	Target    = SpawnInfo.Target;
+	Behavior  = SpawnInfo.Behavior;
+
+	bool Activated = SpawnInfo.Activation != ReceivedActivation;
+	bool Corrected = SpawnInfo.Correction != ReceivedCorrection;
+
+	ReceivedActivation = SpawnInfo.Activation;
+	ReceivedCorrection = SpawnInfo.Correction;
+
+	// The first activation is done by BeginPlay
+	if (!HasActorBegunPlay()) {
+		return;
+	}
+
+	// Released by the server
+	if (!SpawnInfo.Active) {
+		if (Active) {
+			DeactivateProjectile();
+		}
+		return;
+	}
+
+	if (!(Activated || Corrected)) {
+		return;
+	}
+
+	if (Activated) {
+		SetActorLocationAndRotation(SpawnInfo.Location, Direction.Rotation(), false, nullptr, ETeleportType::ResetPhysics);
+		ActivateProjectile();
+		return;
+	}
+
+	ApplyCorrection();
+}
+
+void AGKProjectile::ApplyCorrection() {
+	Direction = SpawnInfo.Direction;
+	SetActorLocationAndRotation(SpawnInfo.Location, Direction.Rotation(), false, nullptr, ETeleportType::ResetPhysics);
+
+	// Restart the simulation from the corrected location
+	if (BatchIndex != INDEX_NONE) {
+		GetWorld()->GetSubsystem<UGKProjectileManagerSubsystem>()->Teleport(this, SpawnInfo.Location, Direction);
+		return;
+	}
+
+	auto Movement = ProjectileMovementComponent;
+	Movement->Velocity = Direction * Movement->Velocity.Size();
+}
+
+void AGKProjectile::RecordHomingTarget() {
+	if (Target == nullptr) {
+		return;
+	}
+
+	SentTargetLocation = Target->GetActorLocation();
+	SentTargetVelocity = Target->GetVelocity();
+	SentTime           = GetWorld()->GetTimeSeconds();
+}
+
+void AGKProjectile::CheckHomingDivergence() {
+	if (!HasAuthority() || !Active || Behavior != EGK_ProjectileBehavior::UnitTarget || Target == nullptr) {
+		return;
+	}
+
+	// Clients follow their own copy of the target, they only diverge when the target
+	// does something its replicated movement does not show in time (e.g. a blink)
+	float   Now       = GetWorld()->GetTimeSeconds();
+	FVector Predicted = SentTargetLocation + SentTargetVelocity * (Now - SentTime);
+
+	if (FVector::DistSquared(Predicted, Target->GetActorLocation()) <= FMath::Square(HomingCorrectionDistance)) {
+		return;
+	}
+
+	SpawnInfo.Location   = GetActorLocation();
+	SpawnInfo.Direction  = GetActorForwardVector();
+	SpawnInfo.Correction = (SpawnInfo.Correction + 1) & 0xF;
+	SpawnInfo.Quantize();
+
+	// Continue from the state the clients receive, as on activation
+	ApplyCorrection();
+
+	RecordHomingTarget();
+	FlushNetDormancy();
+}
+
+void FGKProjectileSpawnInfo::Quantize() {
+	Location  = FVector(FMath::RoundToFloat(Location.X * 10.f) / 10.f, FMath::RoundToFloat(Location.Y * 10.f) / 10.f, FMath::RoundToFloat(Location.Z * 10.f) / 10.f);
+	Direction = QuantizeDirection(Direction);
+	Speed     = float(FMath::RoundToInt(FMath::Max(Speed, 0.f)));
+	Range     = float(FMath::RoundToInt(FMath::Max(Range, 0.f)));
+}
+
+FVector FGKProjectileSpawnInfo::QuantizeDirection(FVector Direction) {
+	FRotator Rotation = Direction.Rotation();
+	Rotation.Pitch    = FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(Rotation.Pitch));
+	Rotation.Yaw      = FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(Rotation.Yaw));
+	Rotation.Roll     = 0.f;
+	return Rotation.Vector();
+}
+
+bool FGKProjectileSpawnInfo::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) {
+	bOutSuccess = SerializePackedVector<10, 24>(Location, Ar);
+
+	// Direction as a packed normal, 16 bits per angle
+	uint16 Pitch = 0;
+	uint16 Yaw   = 0;
+
+	if (Ar.IsSaving()) {
+		FRotator Rotation = Direction.Rotation();
+		Pitch             = FRotator::CompressAxisToShort(Rotation.Pitch);
+		Yaw               = FRotator::CompressAxisToShort(Rotation.Yaw);
+	}
+
+	Ar << Pitch;
+	Ar << Yaw;
+
+	// Speed and range as variable length integers
+	uint32 QuantizedSpeed = uint32(FMath::RoundToInt(FMath::Max(Speed, 0.f)));
+	uint32 QuantizedRange = uint32(FMath::RoundToInt(FMath::Max(Range, 0.f)));
+
+	Ar.SerializeIntPacked(QuantizedSpeed);
+	Ar.SerializeIntPacked(QuantizedRange);
+
+	uint8 QuantizedBehavior = uint8(Behavior);
+	uint8 QuantizedActive   = Active ? 1 : 0;
+	Ar.SerializeBits(&QuantizedBehavior, 2);
+	Ar.SerializeBits(&QuantizedActive, 1);
+	Ar << Activation;
+	Ar.SerializeBits(&Correction, 4);
+
+	UObject* TargetObject = Target;
+	if (Map != nullptr) {
+		bOutSuccess &= Map->SerializeObject(Ar, AActor::StaticClass(), TargetObject);
+	}
+
+	if (Ar.IsLoading()) {
+		Direction  = FRotator(FRotator::DecompressAxisFromShort(Pitch), FRotator::DecompressAxisFromShort(Yaw), 0.f).Vector();
+		Speed      = float(QuantizedSpeed);
+		Range      = float(QuantizedRange);
+		Behavior   = EGK_ProjectileBehavior(QuantizedBehavior & 0x3);
+		Active     = (QuantizedActive & 0x1) != 0;
+		Correction = Correction & 0xF;
+		Target     = Cast<AActor>(TargetObject);
+	}
+
+	return true;
 }
 
 void AGKProjectile::InitProjectileMovement() {
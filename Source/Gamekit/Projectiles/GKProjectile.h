@@ -8,6 +8,8 @@
 
 #include "GKProjectile.generated.h"
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FGKProjectileHitDelegate, const FHitResult&, Hit);
+
 UENUM(BlueprintType)
 enum class EGK_ProjectileBehavior : uint8
 {
@@ -16,6 +18,68 @@ enum class EGK_ProjectileBehavior : uint8
 };
 
 
+/** Everything a client needs to simulate a projectile, sent when the projectile is activated
+ *
+ * The payload is quantized and bit-packed, the movement itself is not replicated,
+ * clients simulate the projectile from this state.
+ */
+USTRUCT()
+struct GAMEKIT_API FGKProjectileSpawnInfo
+{
+	GENERATED_BODY()
+
+	//! Quantized to 0.1 unit
+	UPROPERTY()
+	FVector Location = FVector::ZeroVector;
+
+	//! Sent as a compressed pitch and yaw
+	UPROPERTY()
+	FVector Direction = FVector::ForwardVector;
+
+	//! Rounded to 1 unit/s
+	UPROPERTY()
+	float Speed = 0.f;
+
+	//! Rounded to 1 unit
+	UPROPERTY()
+	float Range = 0.f;
+
+	//! Sent as a net GUID
+	UPROPERTY()
+	AActor* Target = nullptr;
+
+	UPROPERTY()
+	EGK_ProjectileBehavior Behavior = EGK_ProjectileBehavior::Directional;
+
+	//! Incremented each time the projectile is activated
+	UPROPERTY()
+	uint8 Activation = 0;
+
+	//! False while the projectile waits in the pool
+	UPROPERTY()
+	bool Active = false;
+
+	//! Incremented (4 bits) each time the server corrects the location of a seeking projectile
+	UPROPERTY()
+	uint8 Correction = 0;
+
+	//! Round the values the way NetSerialize does, so the server can simulate what the clients receive
+	void Quantize();
+
+	static FVector QuantizeDirection(FVector Direction);
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template <>
+struct TStructOpsTypeTraits<FGKProjectileSpawnInfo>: public TStructOpsTypeTraitsBase2<FGKProjectileSpawnInfo>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
 UCLASS(BlueprintType)
 class GAMEKIT_API AGKProjectile : public AGKAbilityEffectActor
 {
@@ -29,6 +93,8 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -37,27 +103,96 @@ public:
 
 	void InitProjectileMovement();
 
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Replicated, Category = Projectile);
+	//! Reset the projectile at its current location and start moving
+	void ActivateProjectile();
+
+	//! Stop, hide and disable collisions, the projectile can be activated again later
+	void DeactivateProjectile();
+
+	bool IsProjectileActive() const { return Active; }
+
+	//! Server side, start in the pool instead of moving on BeginPlay (prewarmed projectiles)
+	bool ActivateOnBeginPlay = true;
+
+	//! Done with the projectile, return it to the UGKProjectilePoolSubsystem
+	//! Only the server releases projectiles, clients just hide them until the server reuses them
+	UFUNCTION(BlueprintCallable, Category = Projectile)
+	void Release();
+
+	// The properties below are sent to the clients through SpawnInfo when the projectile is activated
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Projectile);
 	float Speed;
 
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Replicated, Category = Projectile);
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Projectile);
 	FVector Direction;
 
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Replicated, Category = Projectile);
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Projectile);
 	AActor* Target;
 
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Replicated, Category = Projectile);
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Projectile);
 	EGK_ProjectileBehavior Behavior;
 
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Replicated, Category = Projectile);
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Projectile);
 	float Range;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Projectile);
 	class UProjectileMovementComponent* ProjectileMovementComponent;
 
+	//! Simulated by UGKProjectileManagerSubsystem instead of its own tick and movement component
+	//! the actor collisions are disabled, hits are reported through OnProjectileHit
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Projectile);
+	bool Batched = false;
+
+	//! Called when a batched projectile hits something, the projectile is released afterwards
+	UPROPERTY(BlueprintAssignable, Category = Projectile)
+	FGKProjectileHitDelegate OnProjectileHit;
+
+	void NotifyBatchedHit(FHitResult const& Hit);
+
+	//! Clients are corrected when the target of a seeking projectile is this far
+	//! from where the server expected it to be when it last sent the projectile state
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Projectile);
+	float HomingCorrectionDistance = 200.f;
+
+	//! Server side, send the projectile location again if the target moved unexpectedly (e.g. teleported)
+	void CheckHomingDivergence();
+
 	UPROPERTY()
 	float DistanceTravelled = 0.f;
 
 	UPROPERTY()
 	FVector PreviousLoc;
+
+protected:
+	//! Only replicated property, sent when the projectile is activated or corrected
+	UPROPERTY(ReplicatedUsing = OnRep_SpawnInfo)
+	FGKProjectileSpawnInfo SpawnInfo;
+
+	UFUNCTION()
+	void OnRep_SpawnInfo();
+
+	//! Server side, target state the clients were last synchronized with
+	void RecordHomingTarget();
+
+	//! Continue the flight from the location and direction of SpawnInfo
+	void ApplyCorrection();
+
+	FVector SentTargetLocation;
+	FVector SentTargetVelocity;
+	float   SentTime = 0.f;
+
+	// Client side, last state received
+	uint8 ReceivedActivation = 0;
+	uint8 ReceivedCorrection = 0;
+
+	bool Active = false;
+
+	//! Incremented each time the projectile is activated
+	int32 Activation = 0;
+
+	//! Index inside UGKProjectileManagerSubsystem
+	int32 BatchIndex = INDEX_NONE;
+
+	friend class UGKProjectileManagerSubsystem;
 };
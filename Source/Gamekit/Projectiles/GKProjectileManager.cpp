@@ -0,0 +1,316 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#include "Projectiles/GKProjectileManager.h"
+
+#include "Gamekit.h"
+#include "Projectiles/GKProjectile.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+
+void UGKProjectileManagerSubsystem::Add(AGKProjectile* Projectile) {
+	if (Projectile == nullptr || Projectile->BatchIndex != INDEX_NONE) {
+		return;
+	}
+
+	FVector Position  = Projectile->GetActorLocation();
+	FVector Direction = Projectile->Direction.GetSafeNormal();
+
+	if (Direction.IsZero()) {
+		Direction = Projectile->GetActorForwardVector();
+	}
+
+	FVector Velocity = Direction * Projectile->Speed;
+	bool    Seeking  = Projectile->Behavior == EGK_ProjectileBehavior::UnitTarget && Projectile->Target != nullptr;
+
+	Projectile->BatchIndex = Projectiles.Add(Projectile);
+
+	PositionX.Add(Position.X);
+	PositionY.Add(Position.Y);
+	PositionZ.Add(Position.Z);
+	VelocityX.Add(Velocity.X);
+	VelocityY.Add(Velocity.Y);
+	VelocityZ.Add(Velocity.Z);
+	Speed.Add(Projectile->Speed);
+
+	// Seeking projectiles do not have a range, same as the non batched projectiles
+	RangeLeft.Add(Seeking ? MAX_flt : Projectile->Range);
+	Targets.Add(Seeking ? Projectile->Target : nullptr);
+
+	// Sweep with the collision settings of the root even if the actor collisions are disabled
+	FCollision& Collision = Collisions.AddDefaulted_GetRef();
+	Collision.Instigator  = Projectile->GetInstigator();
+
+	if (UPrimitiveComponent* Root = Cast<UPrimitiveComponent>(Projectile->GetRootComponent())) {
+		Collision.Channel  = Root->GetCollisionObjectType();
+		Collision.Shape    = Root->GetCollisionShape();
+		Collision.Response = FCollisionResponseParams(Root->GetCollisionResponseToChannels());
+	}
+}
+
+void UGKProjectileManagerSubsystem::Remove(AGKProjectile* Projectile) {
+	if (Projectile == nullptr) {
+		return;
+	}
+
+	int32 Index = Projectile->BatchIndex;
+	if (!Projectiles.IsValidIndex(Index) || Projectiles[Index] != Projectile) {
+		return;
+	}
+
+	RemoveAt(Index);
+	Projectile->BatchIndex = INDEX_NONE;
+}
+
+void UGKProjectileManagerSubsystem::Teleport(AGKProjectile* Projectile, FVector Location, FVector Direction) {
+	int32 Index = Projectile != nullptr ? Projectile->BatchIndex : INDEX_NONE;
+	if (!Projectiles.IsValidIndex(Index)) {
+		return;
+	}
+
+	FVector Velocity = Direction.GetSafeNormal() * Speed[Index];
+
+	PositionX[Index] = Location.X;
+	PositionY[Index] = Location.Y;
+	PositionZ[Index] = Location.Z;
+	VelocityX[Index] = Velocity.X;
+	VelocityY[Index] = Velocity.Y;
+	VelocityZ[Index] = Velocity.Z;
+
+	// The pending sweep covers the path before the correction
+	Collisions[Index].Sweep = FTraceHandle();
+}
+
+void UGKProjectileManagerSubsystem::RemoveAt(int32 Index) {
+	// Swap with the last projectile to keep the arrays packed
+	Projectiles.RemoveAtSwap(Index, 1, false);
+	PositionX.RemoveAtSwap(Index, 1, false);
+	PositionY.RemoveAtSwap(Index, 1, false);
+	PositionZ.RemoveAtSwap(Index, 1, false);
+	VelocityX.RemoveAtSwap(Index, 1, false);
+	VelocityY.RemoveAtSwap(Index, 1, false);
+	VelocityZ.RemoveAtSwap(Index, 1, false);
+	Speed.RemoveAtSwap(Index, 1, false);
+	RangeLeft.RemoveAtSwap(Index, 1, false);
+	Targets.RemoveAtSwap(Index, 1, false);
+	Collisions.RemoveAtSwap(Index, 1, false);
+
+	if (Projectiles.IsValidIndex(Index) && Projectiles[Index] != nullptr) {
+		Projectiles[Index]->BatchIndex = Index;
+	}
+}
+
+void UGKProjectileManagerSubsystem::Deinitialize() {
+	for (AGKProjectile* Projectile: Projectiles) {
+		if (Projectile != nullptr) {
+			Projectile->BatchIndex = INDEX_NONE;
+		}
+	}
+
+	Projectiles.Reset();
+	PositionX.Reset();
+	PositionY.Reset();
+	PositionZ.Reset();
+	VelocityX.Reset();
+	VelocityY.Reset();
+	VelocityZ.Reset();
+	Speed.Reset();
+	RangeLeft.Reset();
+	Targets.Reset();
+	Collisions.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UGKProjectileManagerSubsystem::IsTickable() const { return !IsTemplate() && Projectiles.Num() > 0; }
+
+TStatId UGKProjectileManagerSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGKProjectileManagerSubsystem, STATGROUP_Tickables);
+}
+
+void UGKProjectileManagerSubsystem::ResolveSweeps(TArray<TPair<AGKProjectile*, FHitResult>>& Hits) {
+	UWorld* World = GetWorld();
+
+	for (int32 i = 0; i < Projectiles.Num(); i++) {
+		FTraceHandle& Sweep = Collisions[i].Sweep;
+
+		// Async traces are resolved at the end of the frame they were requested in
+		FTraceDatum Datum;
+		if (!Sweep.IsValid() || !World->QueryTraceData(Sweep, Datum)) {
+			continue;
+		}
+
+		Sweep = FTraceHandle();
+
+		for (FHitResult const& Hit: Datum.OutHits) {
+			if (Hit.bBlockingHit) {
+				Hits.Emplace(Projectiles[i], Hit);
+				break;
+			}
+		}
+	}
+}
+
+void UGKProjectileManagerSubsystem::Steer(float DeltaTime, bool Authority, TArray<TPair<AGKProjectile*, FHitResult>>& Hits) {
+	for (int32 i = 0; i < Projectiles.Num(); i++) {
+		if (Targets[i].IsExplicitlyNull()) {
+			continue;
+		}
+
+		AActor* Target = Targets[i].Get();
+
+		// Target is gone, nothing to seek
+		if (Target == nullptr) {
+			RangeLeft[i] = 0.f;
+			continue;
+		}
+
+		// A correction snaps the projectile, steer from the corrected location like the clients
+		Projectiles[i]->CheckHomingDivergence();
+
+		FVector Position(PositionX[i], PositionY[i], PositionZ[i]);
+		FVector Delta    = Target->GetActorLocation() - Position;
+		float   Distance = Delta.Size();
+		float   Step     = Speed[i] * DeltaTime;
+
+		if (Distance <= Step || Distance < KINDA_SMALL_NUMBER) {
+			// Clients only hide the projectile once it lands, the server reports the hit
+			if (Authority) {
+				FVector Normal = Distance < KINDA_SMALL_NUMBER ? FVector::UpVector : -Delta / Distance;
+				Hits.Emplace(Projectiles[i], FHitResult(Target, Cast<UPrimitiveComponent>(Target->GetRootComponent()), Target->GetActorLocation(), Normal));
+			} else {
+				RangeLeft[i] = 0.f;
+			}
+
+			// Land on the target this frame
+			Delta = Delta / FMath::Max(DeltaTime, SMALL_NUMBER);
+		}
+		else {
+			Delta = Delta * (Speed[i] / Distance);
+		}
+
+		VelocityX[i] = Delta.X;
+		VelocityY[i] = Delta.Y;
+		VelocityZ[i] = Delta.Z;
+	}
+}
+
+void UGKProjectileManagerSubsystem::Integrate(float DeltaTime) {
+	int32 const N = Projectiles.Num();
+
+	float* RESTRICT       PX = PositionX.GetData();
+	float* RESTRICT       PY = PositionY.GetData();
+	float* RESTRICT       PZ = PositionZ.GetData();
+	float const* RESTRICT VX = VelocityX.GetData();
+	float const* RESTRICT VY = VelocityY.GetData();
+	float const* RESTRICT VZ = VelocityZ.GetData();
+	float const* RESTRICT S  = Speed.GetData();
+	float* RESTRICT       R  = RangeLeft.GetData();
+
+	// Separate arrays without aliasing, the compiler vectorizes this loop
+	for (int32 i = 0; i < N; i++) {
+		PX[i] += VX[i] * DeltaTime;
+		PY[i] += VY[i] * DeltaTime;
+		PZ[i] += VZ[i] * DeltaTime;
+		R[i] -= S[i] * DeltaTime;
+	}
+}
+
+void UGKProjectileManagerSubsystem::StartSweeps(float DeltaTime) {
+	UWorld* World = GetWorld();
+
+	for (int32 i = 0; i < Projectiles.Num(); i++) {
+		if (!Targets[i].IsExplicitlyNull()) {
+			continue;
+		}
+
+		FCollision& Collision = Collisions[i];
+
+		FVector End(PositionX[i], PositionY[i], PositionZ[i]);
+		FVector Start = End - FVector(VelocityX[i], VelocityY[i], VelocityZ[i]) * DeltaTime;
+
+		FCollisionQueryParams Params(SCENE_QUERY_STAT(GKProjectileSweep), false, Collision.Instigator.Get());
+		Params.AddIgnoredActor(Projectiles[i]);
+
+		Collision.Sweep = World->AsyncSweepByChannel(
+			EAsyncTraceType::Single,
+			Start,
+			End,
+			FQuat::Identity,
+			Collision.Channel,
+			Collision.Shape,
+			Params,
+			Collision.Response
+		);
+	}
+}
+
+void UGKProjectileManagerSubsystem::Tick(float DeltaTime) {
+	UWorld* World = GetWorld();
+	if (World == nullptr) {
+		return;
+	}
+
+	// Collisions are the server business
+	bool const Authority = World->GetNetMode() != NM_Client;
+
+	TArray<TPair<AGKProjectile*, FHitResult>> Hits;
+
+	if (Authority) {
+		ResolveSweeps(Hits);
+	}
+
+	Steer(DeltaTime, Authority, Hits);
+	Integrate(DeltaTime);
+
+	if (Authority) {
+		StartSweeps(DeltaTime);
+	}
+
+	// Move the visuals and gather the projectiles that went out of range
+	// the activation tells if the projectile was reused by a hit event in the meantime
+	TArray<TPair<AGKProjectile*, int32>> Expired;
+
+	for (int32 i = 0; i < Projectiles.Num(); i++) {
+		AGKProjectile* Projectile = Projectiles[i];
+
+		if (!IsValid(Projectile)) {
+			continue;
+		}
+
+		FVector Velocity(VelocityX[i], VelocityY[i], VelocityZ[i]);
+
+		Projectile->SetActorLocationAndRotation(
+			FVector(PositionX[i], PositionY[i], PositionZ[i]),
+			Velocity.Rotation(),
+			false,
+			nullptr,
+			ETeleportType::TeleportPhysics
+		);
+
+		if (RangeLeft[i] <= 0.f) {
+			Expired.Emplace(Projectile, Projectile->Activation);
+		}
+	}
+
+	// Hit events can release, spawn or reuse projectiles so they are dispatched
+	// once the arrays are not used anymore
+	for (TPair<AGKProjectile*, FHitResult> const& Hit: Hits) {
+		if (IsValid(Hit.Key) && Hit.Key->BatchIndex != INDEX_NONE) {
+			Hit.Key->NotifyBatchedHit(Hit.Value);
+		}
+	}
+
+	for (TPair<AGKProjectile*, int32> const& Projectile: Expired) {
+		if (IsValid(Projectile.Key) && Projectile.Key->Activation == Projectile.Value) {
+			Projectile.Key->Release();
+		}
+	}
+
+	// Destroyed without being released
+	for (int32 i = Projectiles.Num() - 1; i >= 0; i--) {
+		if (!IsValid(Projectiles[i])) {
+			RemoveAt(i);
+		}
+	}
+}
@@ -0,0 +1,96 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+
+#include "GKProjectileManager.generated.h"
+
+class AGKProjectile;
+
+/** Simulate the batched projectiles (AGKProjectile::Batched) in one update
+ *
+ * The state of the projectiles is stored in parallel arrays and advanced in a single loop,
+ * the actors are only moved to follow the simulation, their tick, movement component
+ * and collisions are disabled.
+ *
+ * Directional projectiles are swept against the world with async traces, all the sweeps
+ * of a frame run in a batch and their results are read on the next frame.
+ * Target seeking projectiles fly straight to their target and only hit it.
+ *
+ * Sweeps only run on the server, clients simulate the movement and wait for the server to release the projectile.
+ */
+UCLASS()
+class GAMEKIT_API UGKProjectileManagerSubsystem
+	: public UWorldSubsystem
+	, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	//! Start simulating the projectile from its current location
+	void Add(AGKProjectile* Projectile);
+
+	//! Stop simulating the projectile
+	void Remove(AGKProjectile* Projectile);
+
+	//! Move a simulated projectile, used when the server corrects its flight
+	void Teleport(AGKProjectile* Projectile, FVector Location, FVector Direction);
+
+	UFUNCTION(BlueprintPure, Category = Projectile)
+	int Num() const { return Projectiles.Num(); }
+
+	void Deinitialize() override;
+
+	// FTickableGameObject
+	void Tick(float DeltaTime) override;
+
+	bool IsTickable() const override;
+
+	TStatId GetStatId() const override;
+
+	UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	struct FCollision
+	{
+		ECollisionChannel        Channel = ECC_WorldDynamic;
+		FCollisionShape          Shape;
+		FCollisionResponseParams Response;
+		TWeakObjectPtr<AActor>   Instigator;
+		FTraceHandle             Sweep;
+	};
+
+	void RemoveAt(int32 Index);
+
+	void ResolveSweeps(TArray<TPair<AGKProjectile*, FHitResult>>& Hits);
+
+	void Steer(float DeltaTime, bool Authority, TArray<TPair<AGKProjectile*, FHitResult>>& Hits);
+
+	void Integrate(float DeltaTime);
+
+	void StartSweeps(float DeltaTime);
+
+	UPROPERTY()
+	TArray<AGKProjectile*> Projectiles;
+
+	// Hot state, one entry per projectile
+	TArray<float> PositionX;
+	TArray<float> PositionY;
+	TArray<float> PositionZ;
+	TArray<float> VelocityX;
+	TArray<float> VelocityY;
+	TArray<float> VelocityZ;
+	TArray<float> Speed;
+	TArray<float> RangeLeft;
+
+	// Target of the seeking projectiles, null for directional projectiles
+	TArray<TWeakObjectPtr<AActor>> Targets;
+
+	// Cold state
+	TArray<FCollision> Collisions;
+};
@@ -0,0 +1,106 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#include "Projectiles/GKProjectilePool.h"
+
+#include "Gamekit.h"
+#include "Projectiles/GKProjectile.h"
+
+#include "Kismet/GameplayStatics.h"
+
+AGKProjectile* UGKProjectilePoolSubsystem::SpawnDeferred(TSubclassOf<AGKProjectile> Class, FTransform const& Transform, APawn* Instigator) {
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnInfo.Owner                          = Instigator;
+	SpawnInfo.Instigator                     = Instigator;
+	SpawnInfo.bDeferConstruction             = true;
+
+	return GetWorld()->SpawnActor<AGKProjectile>(Class, Transform, SpawnInfo);
+}
+
+AGKProjectile* UGKProjectilePoolSubsystem::Acquire(TSubclassOf<AGKProjectile> Class, FTransform const& Transform, APawn* Instigator) {
+	if (!Class) {
+		return nullptr;
+	}
+
+	FGKProjectilePoolEntry* Pool = Pools.Find(Class.Get());
+
+	while (Pool != nullptr && Pool->Available.Num() > 0) {
+		AGKProjectile* Projectile = Pool->Available.Pop(false);
+
+		// Something else destroyed it while it was in the pool
+		if (!IsValid(Projectile)) {
+			continue;
+		}
+
+		Projectile->SetOwner(Instigator);
+		Projectile->SetInstigator(Instigator);
+		Projectile->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+		return Projectile;
+	}
+
+	return SpawnDeferred(Class, Transform, Instigator);
+}
+
+void UGKProjectilePoolSubsystem::Start(AGKProjectile* Projectile, FTransform const& Transform) {
+	if (Projectile == nullptr) {
+		return;
+	}
+
+	// New projectiles start in BeginPlay
+	if (!Projectile->HasActorBegunPlay()) {
+		UGameplayStatics::FinishSpawningActor(Projectile, Transform);
+		return;
+	}
+
+	Projectile->ActivateProjectile();
+}
+
+void UGKProjectilePoolSubsystem::Release(AGKProjectile* Projectile) {
+	if (!IsValid(Projectile)) {
+		return;
+	}
+
+	if (!Projectile->IsProjectileActive()) {
+		return;
+	}
+
+	Projectile->DeactivateProjectile();
+	Pools.FindOrAdd(Projectile->GetClass()).Available.Add(Projectile);
+}
+
+void UGKProjectilePoolSubsystem::Prewarm(TSubclassOf<AGKProjectile> Class, int Count) {
+	if (!Class) {
+		return;
+	}
+
+	int32 Missing = Count - NumAvailable(Class);
+	if (Missing <= 0) {
+		return;
+	}
+
+	UE_LOG(LogGamekit, Log, TEXT("Prewarming %d %s"), Missing, *Class->GetName());
+
+	FTransform Transform;
+	for (int32 i = 0; i < Missing; i++) {
+		AGKProjectile* Projectile = SpawnDeferred(Class, Transform, nullptr);
+
+		if (Projectile == nullptr) {
+			return;
+		}
+
+		// Straight to the pool, the projectile was never launched
+		Projectile->ActivateOnBeginPlay = false;
+		UGameplayStatics::FinishSpawningActor(Projectile, Transform);
+		Pools.FindOrAdd(Class.Get()).Available.Add(Projectile);
+	}
+}
+
+int UGKProjectilePoolSubsystem::NumAvailable(TSubclassOf<AGKProjectile> Class) const {
+	FGKProjectilePoolEntry const* Pool = Pools.Find(Class.Get());
+	return Pool != nullptr ? Pool->Available.Num() : 0;
+}
+
+void UGKProjectilePoolSubsystem::Deinitialize() {
+	Pools.Reset();
+	Super::Deinitialize();
+}
@@ -0,0 +1,67 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Templates/SubclassOf.h"
+
+#include "GKProjectilePool.generated.h"
+
+class AGKProjectile;
+
+USTRUCT()
+struct FGKProjectilePoolEntry
+{
+	GENERATED_BODY()
+
+	//! Released projectiles ready to be reused
+	UPROPERTY()
+	TArray<AGKProjectile*> Available;
+};
+
+/** Reuse projectile actors instead of spawning and destroying them
+ *
+ * Projectiles are pooled per class, on the server only, clients follow the replicated state.
+ *
+ * .. code-block:: cpp
+ *
+ *    AGKProjectile* Projectile = Pool->Acquire(Class, Transform, Pawn);
+ *    Projectile->Speed = ...;
+ *    Pool->Start(Projectile, Transform);
+ *
+ *    // Later
+ *    Projectile->Release();
+ */
+UCLASS()
+class GAMEKIT_API UGKProjectilePoolSubsystem: public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//! Take a projectile out of the pool, a new one is spawned when the pool is empty
+	//! the projectile is inactive until Start is called
+	AGKProjectile* Acquire(TSubclassOf<AGKProjectile> Class, FTransform const& Transform, APawn* Instigator);
+
+	//! Start the projectile once its properties are set
+	void Start(AGKProjectile* Projectile, FTransform const& Transform);
+
+	//! Deactivate the projectile and put it back in the pool
+	void Release(AGKProjectile* Projectile);
+
+	//! Spawn projectiles ahead of time until Count projectiles of this class are available
+	UFUNCTION(BlueprintCallable, Category = Projectile)
+	void Prewarm(TSubclassOf<AGKProjectile> Class, int Count);
+
+	//! Number of projectiles ready to be reused
+	UFUNCTION(BlueprintPure, Category = Projectile)
+	int NumAvailable(TSubclassOf<AGKProjectile> Class) const;
+
+	void Deinitialize() override;
+
+private:
+	AGKProjectile* SpawnDeferred(TSubclassOf<AGKProjectile> Class, FTransform const& Transform, APawn* Instigator);
+
+	UPROPERTY()
+	TMap<UClass*, FGKProjectilePoolEntry> Pools;
+};
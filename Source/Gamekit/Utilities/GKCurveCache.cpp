@@ -0,0 +1,166 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#include "Utilities/GKCurveCache.h"
+
+#include "Gamekit.h"
+#include "Abilities/GKAbilityStatic.h"
+
+#include "Engine/CurveTable.h"
+#include "Engine/DataTable.h"
+#include "Misc/Crc.h"
+
+namespace {
+
+int32 GeneratedCurves = 0;
+
+// Keys of the curve, the same for every value array that scales the same way
+bool MakeLevelCurveKeys(TArray<float> const& Values, bool ValuesAreFinal, TArray<FSimpleCurveKey>& Keys) {
+	if (Values.Num() <= 1) {
+		return false;
+	}
+
+	for (float Value: Values) {
+		if (!FMath::IsFinite(Value)) {
+			return false;
+		}
+	}
+
+	float Base = FGKCurveCache::GetLevelCurveBase(Values, ValuesAreFinal);
+
+	Keys.Reset(Values.Num());
+	for (int i = 1 - int(ValuesAreFinal); i < Values.Num(); i++) {
+		float v = ValuesAreFinal ? Values[i] / Base : Values[i];
+		Keys.Add(FSimpleCurveKey(float(i + 1), v));
+	}
+	return true;
+}
+
+uint32 HashKeys(TArray<FSimpleCurveKey> const& Keys) {
+	uint32 Hash = 0;
+	for (FSimpleCurveKey const& Key: Keys) {
+		Hash = FCrc::MemCrc32(&Key.Time, sizeof(Key.Time), Hash);
+		Hash = FCrc::MemCrc32(&Key.Value, sizeof(Key.Value), Hash);
+	}
+	return Hash;
+}
+
+FName CurveName(uint32 Hash) { return FName(*FString::Printf(TEXT("GKCurve.%08X"), Hash)); }
+
+bool SameKeys(FSimpleCurve const& Curve, TArray<FSimpleCurveKey> const& Keys) {
+	TArray<FSimpleCurveKey> const& Existing = Curve.GetConstRefOfKeys();
+
+	if (Existing.Num() != Keys.Num()) {
+		return false;
+	}
+
+	// Compared bit for bit like they are hashed
+	for (int i = 0; i < Keys.Num(); i++) {
+		if (FMemory::Memcmp(&Existing[i].Time, &Keys[i].Time, sizeof(float)) != 0 ||
+		    FMemory::Memcmp(&Existing[i].Value, &Keys[i].Value, sizeof(float)) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Find the row holding Keys, or the free row it should go in
+// collisions are resolved by probing the next hash
+bool FindRow(UCurveTable const* Table, TArray<FSimpleCurveKey> const& Keys, FName& Name) {
+	static const FString Context(TEXT("FGKCurveCache"));
+
+	for (uint32 Hash = HashKeys(Keys);; Hash++) {
+		Name = CurveName(Hash);
+
+		FSimpleCurve* Curve = Table->FindSimpleCurve(Name, Context, false);
+		if (Curve == nullptr) {
+			return false;
+		}
+
+		if (SameKeys(*Curve, Keys)) {
+			return true;
+		}
+	}
+}
+
+bool CanHoldCurves(UCurveTable const* Table) {
+	if (Table == nullptr) {
+		return false;
+	}
+
+	if (Table->GetCurveTableMode() == ECurveTableMode::RichCurves) {
+		UE_LOG(LogGamekit, Warning, TEXT("%s holds rich curves, level curves need a table of simple curves"), *Table->GetName());
+		return false;
+	}
+	return true;
+}
+
+} // namespace
+
+FName FGKCurveCache::FindOrAddLevelCurve(UCurveTable* Table, TArray<float> const& Values, bool ValuesAreFinal) {
+	TArray<FSimpleCurveKey> Keys;
+	if (!CanHoldCurves(Table) || !MakeLevelCurveKeys(Values, ValuesAreFinal, Keys)) {
+		return NAME_None;
+	}
+
+	FName Name;
+	if (FindRow(Table, Keys, Name)) {
+		return Name;
+	}
+
+	FSimpleCurve& Curve = Table->AddSimpleCurve(Name);
+	Curve.SetKeys(Keys);
+
+	GeneratedCurves += 1;
+	UE_LOG(LogGamekit, Verbose, TEXT("Generated curve %s in %s"), *Name.ToString(), *Table->GetName());
+	return Name;
+}
+
+FName FGKCurveCache::FindLevelCurve(UCurveTable const* Table, TArray<float> const& Values, bool ValuesAreFinal) {
+	TArray<FSimpleCurveKey> Keys;
+	if (!CanHoldCurves(Table) || !MakeLevelCurveKeys(Values, ValuesAreFinal, Keys)) {
+		return NAME_None;
+	}
+
+	FName Name;
+	return FindRow(Table, Keys, Name) ? Name : NAME_None;
+}
+
+float FGKCurveCache::GetLevelCurveBase(TArray<float> const& Values, bool ValuesAreFinal) {
+	if (Values.Num() == 0 || (ValuesAreFinal && Values[0] == 0.f)) {
+		return 1.f;
+	}
+	return Values[0];
+}
+
+int32 FGKCurveCache::NumGenerated() { return GeneratedCurves; }
+
+int UGKCurveCacheLibrary::BuildAbilityCurves(UDataTable* Abilities, UCurveTable* Curves) {
+	if (Abilities == nullptr || !CanHoldCurves(Curves)) {
+		return 0;
+	}
+
+	UScriptStruct const* RowStruct = Abilities->GetRowStruct();
+	if (RowStruct == nullptr || !RowStruct->IsChildOf(FGKAbilityStatic::StaticStruct())) {
+		UE_LOG(LogGamekit, Warning, TEXT("%s does not hold FGKAbilityStatic rows"), *Abilities->GetName());
+		return 0;
+	}
+
+	Curves->Modify();
+	int32 Before = Curves->GetRowMap().Num();
+
+	// Must match the curves UGKGameplayAbility generates when it loads
+	for (TPair<FName, uint8*> const& Row: Abilities->GetRowMap()) {
+		FGKAbilityStatic const* Ability = reinterpret_cast<FGKAbilityStatic const*>(Row.Value);
+
+		FGKCurveCache::FindOrAddLevelCurve(Curves, Ability->Cooldown, true);
+		FGKCurveCache::FindOrAddLevelCurve(Curves, Ability->Cost.Value, true);
+	}
+
+	int32 Added = Curves->GetRowMap().Num() - Before;
+	if (Added > 0) {
+		Curves->MarkPackageDirty();
+	}
+
+	UE_LOG(LogGamekit, Log, TEXT("Added %d curves to %s for %d abilities"), Added, *Curves->GetName(), Abilities->GetRowMap().Num());
+	return Added;
+}
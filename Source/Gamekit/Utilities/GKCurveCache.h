@@ -0,0 +1,52 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+
+#include "GKCurveCache.generated.h"
+
+class UCurveTable;
+class UDataTable;
+
+/** Level curves generated from the value arrays of the ability rows, shared by content
+ *
+ * A curve is stored in the curve table under a name derived from the hash of its keys
+ * so identical curves (e.g. the same cooldown progression used by many abilities)
+ * are stored once. The table can be built ahead of time with UGKCurveCacheLibrary
+ * and saved with the project, at runtime the curves are then only looked up.
+ *
+ * Game thread only.
+ */
+struct GAMEKIT_API FGKCurveCache
+{
+	//! Row of the curve generated from Values, the curve is added to Table if it is not there yet
+	//! if ValuesAreFinal == 1 then the curve is Values[Level] / GetLevelCurveBase(Values)
+	//! if ValuesAreFinal == 0 then the curve is Values[Level], the first value is the base
+	//! Returns NAME_None if there are not enough values to make a curve or a value is not finite
+	static FName FindOrAddLevelCurve(UCurveTable* Table, TArray<float> const& Values, bool ValuesAreFinal);
+
+	//! Value the curve is multiplied by, Values[0] unless the final values start at 0
+	//! in which case the curve holds the values themselves and the base is 1
+	static float GetLevelCurveBase(TArray<float> const& Values, bool ValuesAreFinal);
+
+	//! Same as FindOrAddLevelCurve but never modifies the table
+	static FName FindLevelCurve(UCurveTable const* Table, TArray<float> const& Values, bool ValuesAreFinal);
+
+	//! Number of curves generated at runtime, 0 when the table was built ahead of time
+	static int32 NumGenerated();
+};
+
+UCLASS()
+class GAMEKIT_API UGKCurveCacheLibrary: public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	//! Add the cooldown and cost curves of every ability of Abilities to Curves
+	//! Call it from an editor utility before cooking, then save Curves
+	//! Returns the number of curves added
+	UFUNCTION(BlueprintCallable, Category = "Abilities|Curves")
+	static int BuildAbilityCurves(UDataTable* Abilities, UCurveTable* Curves);
+};
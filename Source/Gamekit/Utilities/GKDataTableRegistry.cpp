@@ -0,0 +1,115 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#include "Utilities/GKDataTableRegistry.h"
+
+#include "Gamekit.h"
+
+FGKDataTableRegistry& FGKDataTableRegistry::Get() {
+	static FGKDataTableRegistry Registry;
+	return Registry;
+}
+
+uint8* FGKDataTableRegistry::FindRow(UDataTable* Table, FName RowName, UScriptStruct const* Struct, TCHAR const* Context) {
+	if (Table == nullptr) {
+		return nullptr;
+	}
+
+	TPair<UDataTable const*, FName> Key(Table, RowName);
+
+	// The weak pointer rejects entries of a collected table whose address was reused
+	FRowEntry* Entry = Rows.Find(Key);
+	if (Entry != nullptr && Entry->Table.Get() == Table) {
+		return Entry->Row;
+	}
+
+	Listen(Table);
+
+	uint8* Row = nullptr;
+
+	if (Table->GetRowStruct() == nullptr || !Table->GetRowStruct()->IsChildOf(Struct)) {
+		UE_LOG(LogGamekit, Warning, TEXT("%s: %s rows are not %s"), Context, *Table->GetPathName(), *Struct->GetName());
+	} else {
+		Row = Table->FindRowUnchecked(RowName);
+
+		if (Row == nullptr) {
+			UE_LOG(LogGamekit, Warning, TEXT("%s: row %s not found in %s"), Context, *RowName.ToString(), *Table->GetPathName());
+		}
+	}
+
+	Rows.Add(Key, {Table, Row});
+	return Row;
+}
+
+UObject* FGKDataTableRegistry::FindOrAddDerived(UDataTable* Table, FName RowName, FName Kind, TFunctionRef<UObject*()> Make) {
+	if (Table == nullptr) {
+		return Make();
+	}
+
+	TTuple<UDataTable const*, FName, FName> Key(Table, RowName, Kind);
+
+	FDerivedEntry* Entry = Derived.Find(Key);
+	if (Entry != nullptr && Entry->Table.Get() == Table) {
+		return Entry->Object;
+	}
+
+	Listen(Table);
+
+	UObject* Object = Make();
+	Derived.Add(Key, {Table, Object});
+	return Object;
+}
+
+void FGKDataTableRegistry::Listen(UDataTable* Table) {
+	FTableEntry& Entry = Tables.FindOrAdd(Table);
+
+	if (Entry.Table.Get() != Table) {
+		Entry.Table    = Table;
+		Entry.Revision = 0;
+		Entry.Handle   = Table->OnDataTableChanged().AddRaw(this, &FGKDataTableRegistry::OnDataTableChanged, Table);
+	}
+}
+
+uint32 FGKDataTableRegistry::GetTableRevision(UDataTable const* Table) const {
+	FTableEntry const* Entry = Tables.Find(Table);
+	return Entry != nullptr && Entry->Table.Get() == Table ? Entry->Revision : 0;
+}
+
+void FGKDataTableRegistry::OnDataTableChanged(UDataTable* Table) {
+	for (auto It = Rows.CreateIterator(); It; ++It) {
+		if (It->Key.Key == Table) {
+			It.RemoveCurrent();
+		}
+	}
+
+	// Users keep their reference until they reload
+	for (auto It = Derived.CreateIterator(); It; ++It) {
+		if (It->Key.Get<0>() == Table) {
+			It.RemoveCurrent();
+		}
+	}
+
+	Revision += 1;
+
+	if (FTableEntry* Entry = Tables.Find(Table)) {
+		Entry->Revision = Revision;
+	}
+}
+
+void FGKDataTableRegistry::Reset() {
+	for (TPair<UDataTable const*, FTableEntry>& Table: Tables) {
+		if (UDataTable* DataTable = Table.Value.Table.Get()) {
+			DataTable->OnDataTableChanged().Remove(Table.Value.Handle);
+		}
+	}
+
+	Rows.Reset();
+	Derived.Reset();
+	Tables.Reset();
+	Revision += 1;
+}
+
+void FGKDataTableRegistry::AddReferencedObjects(FReferenceCollector& Collector) {
+	for (TPair<TTuple<UDataTable const*, FName, FName>, FDerivedEntry>& Entry: Derived) {
+		Collector.AddReferencedObject(Entry.Value.Object);
+	}
+}
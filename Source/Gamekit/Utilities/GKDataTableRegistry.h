@@ -0,0 +1,92 @@
+// BSD 3-Clause License Copyright (c) 2021, Pierre Delaunay All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "Templates/Function.h"
+#include "UObject/GCObject.h"
+#include "UObject/WeakObjectPtr.h"
+
+/** Process wide cache of DataTable rows
+ *
+ * Each (DataTable, RowName) is resolved once and the row pointer is shared by every
+ * instance that uses it. Missing rows are cached as well so they are only reported once.
+ *
+ * The registry listens to each table once, when a table changes its rows are dropped
+ * and the revision is incremented, users compare the revision they resolved their row at
+ * to know when to look it up again.
+ *
+ * Objects generated from a row (e.g. the cooldown effect of an ability) can be interned
+ * in the registry as well, they are created once, shared and kept alive until the table changes.
+ *
+ * Game thread only.
+ */
+class GAMEKIT_API FGKDataTableRegistry: public FGCObject
+{
+public:
+	static FGKDataTableRegistry& Get();
+
+	//! Row of Table, nullptr if missing or not a Struct
+	uint8* FindRow(UDataTable* Table, FName RowName, UScriptStruct const* Struct, TCHAR const* Context);
+
+	template <typename T>
+	T* FindRow(UDataTable* Table, FName RowName, TCHAR const* Context) {
+		return reinterpret_cast<T*>(FindRow(Table, RowName, T::StaticStruct(), Context));
+	}
+
+	//! Incremented every time a table changes, starts at 1
+	uint32 GetRevision() const { return Revision; }
+
+	//! Revision of the last change of Table, 0 if it never changed
+	uint32 GetTableRevision(UDataTable const* Table) const;
+
+	//! Object generated from a row, Make is only called the first time a (Table, RowName, Kind) is requested
+	//! Make can return nullptr, it is cached as well
+	UObject* FindOrAddDerived(UDataTable* Table, FName RowName, FName Kind, TFunctionRef<UObject*()> Make);
+
+	template <typename T>
+	T* FindOrAddDerived(UDataTable* Table, FName RowName, FName Kind, TFunctionRef<T*()> Make) {
+		return Cast<T>(FindOrAddDerived(Table, RowName, Kind, [&Make]() -> UObject* { return Make(); }));
+	}
+
+	//! Number of interned objects
+	int32 NumDerived() const { return Derived.Num(); }
+
+	//! Drop every cached row and interned object
+	void Reset();
+
+	// FGCObject
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+
+	virtual FString GetReferencerName() const override { return TEXT("FGKDataTableRegistry"); }
+
+private:
+	struct FRowEntry
+	{
+		TWeakObjectPtr<UDataTable> Table;
+		uint8*                     Row = nullptr;
+	};
+
+	struct FDerivedEntry
+	{
+		TWeakObjectPtr<UDataTable> Table;
+		UObject*                   Object = nullptr;
+	};
+
+	struct FTableEntry
+	{
+		TWeakObjectPtr<UDataTable> Table;
+		FDelegateHandle            Handle;
+		uint32                     Revision = 0;
+	};
+
+	void OnDataTableChanged(UDataTable* Table);
+
+	void Listen(UDataTable* Table);
+
+	TMap<TPair<UDataTable const*, FName>, FRowEntry>             Rows;
+	TMap<TTuple<UDataTable const*, FName, FName>, FDerivedEntry> Derived;
+	TMap<UDataTable const*, FTableEntry>                         Tables;
+	uint32                                                       Revision = 1;
+};